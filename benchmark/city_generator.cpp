@@ -0,0 +1,313 @@
+// Generates a synthetic transport network with a mix of stat requests as the
+// program's JSON input:
+//
+//   city_generator --stops 2000 --buses 300 --requests 10000 > city.json
+//
+// Every option has a default, see PrintUsage.
+
+#include "../transport-catalogue/geo.h"
+#include "../transport-catalogue/json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct GeneratorSettings {
+    int stops = 1000;
+    int buses = 150;
+    int min_route_length = 5;
+    int max_route_length = 30;
+    double roundtrip_share = 0.5;
+    // Average number of extra road distances per stop, besides the ones routes require.
+    double distance_density = 2.0;
+    int requests = 5000;
+    int bus_weight = 30;
+    int stop_weight = 30;
+    int route_weight = 39;
+    int map_weight = 1;
+    unsigned seed = 42;
+};
+
+void PrintUsage(ostream& out) {
+    const GeneratorSettings defaults;
+    out << "Usage: city_generator [options] > input.json\n"
+        << "  --stops N             number of stops (" << defaults.stops << ")\n"
+        << "  --buses N             number of buses (" << defaults.buses << ")\n"
+        << "  --min-route-length N  fewest stops in a route (" << defaults.min_route_length << ")\n"
+        << "  --max-route-length N  most stops in a route (" << defaults.max_route_length << ")\n"
+        << "  --roundtrip-share X   share of roundtrip buses, 0..1 (" << defaults.roundtrip_share << ")\n"
+        << "  --distance-density X  extra road distances per stop (" << defaults.distance_density << ")\n"
+        << "  --requests N          number of stat requests (" << defaults.requests << ")\n"
+        << "  --mix B:S:R:M         Bus:Stop:Route:Map request weights ("
+        << defaults.bus_weight << ':' << defaults.stop_weight << ':'
+        << defaults.route_weight << ':' << defaults.map_weight << ")\n"
+        << "  --seed N              random seed (" << defaults.seed << ")\n";
+}
+
+GeneratorSettings ParseArguments(int argc, char** argv) {
+    GeneratorSettings settings;
+    for (int i = 1; i < argc; ++i) {
+        const string option = argv[i];
+        if (option == "--help") {
+            PrintUsage(cout);
+            exit(0);
+        }
+        if (i + 1 == argc) {
+            throw invalid_argument("Missing value for "s + option);
+        }
+        const string value = argv[++i];
+        if (option == "--stops") {
+            settings.stops = stoi(value);
+        } else if (option == "--buses") {
+            settings.buses = stoi(value);
+        } else if (option == "--min-route-length") {
+            settings.min_route_length = stoi(value);
+        } else if (option == "--max-route-length") {
+            settings.max_route_length = stoi(value);
+        } else if (option == "--roundtrip-share") {
+            settings.roundtrip_share = stod(value);
+        } else if (option == "--distance-density") {
+            settings.distance_density = stod(value);
+        } else if (option == "--requests") {
+            settings.requests = stoi(value);
+        } else if (option == "--mix") {
+            char separator;
+            istringstream weights(value);
+            weights >> settings.bus_weight >> separator >> settings.stop_weight >> separator
+                    >> settings.route_weight >> separator >> settings.map_weight;
+            if (!weights) {
+                throw invalid_argument("--mix expects four weights like 30:30:39:1"s);
+            }
+        } else if (option == "--seed") {
+            settings.seed = static_cast<unsigned>(stoul(value));
+        } else {
+            throw invalid_argument("Unknown option "s + option);
+        }
+    }
+    if (settings.stops < 2 || settings.buses < 1 || settings.min_route_length < 2
+        || settings.max_route_length < settings.min_route_length) {
+        throw invalid_argument("Need at least 2 stops, 1 bus and 2 <= min-route-length <= max-route-length"s);
+    }
+    return settings;
+}
+
+class CityGenerator {
+public:
+    explicit CityGenerator(const GeneratorSettings& settings)
+        : settings_(settings)
+        , random_(settings.seed) {
+    }
+
+    json::Node Generate() {
+        GenerateStops();
+        GenerateBuses();
+        GenerateExtraDistances();
+
+        json::Array base_requests;
+        base_requests.reserve(stops_.size() + buses_.size());
+        for (size_t i = 0; i < stops_.size(); ++i) {
+            base_requests.push_back(MakeStopRequest(i));
+        }
+        for (const auto& bus : buses_) {
+            base_requests.push_back(MakeBusRequest(bus));
+        }
+
+        return json::Dict{
+            {"base_requests"s, move(base_requests)},
+            {"render_settings"s, MakeRenderSettings()},
+            {"routing_settings"s, json::Dict{{"bus_wait_time"s, 6}, {"bus_velocity"s, 40}}},
+            {"stat_requests"s, MakeStatRequests()},
+        };
+    }
+
+private:
+    struct Bus {
+        string name;
+        vector<size_t> stops;
+        bool is_roundtrip;
+    };
+
+    // Stops are spread over a square roughly 30 km wide around a city center.
+    static constexpr double CENTER_LAT = 55.75;
+    static constexpr double CENTER_LNG = 37.62;
+    static constexpr double SPREAD = 0.15;
+
+    const GeneratorSettings settings_;
+    mt19937 random_;
+    vector<string> stop_names_;
+    vector<geo::Coordinates> stops_;
+    vector<Bus> buses_;
+    map<pair<size_t, size_t>, int> distances_;
+
+    size_t RandomIndex(size_t size) {
+        return uniform_int_distribution<size_t>(0, size - 1)(random_);
+    }
+
+    void GenerateStops() {
+        uniform_real_distribution<double> offset(-SPREAD, SPREAD);
+        for (int i = 0; i < settings_.stops; ++i) {
+            stop_names_.push_back("Stop "s + to_string(i));
+            stops_.push_back({CENTER_LAT + offset(random_), CENTER_LNG + offset(random_)});
+        }
+    }
+
+    // Road distance is the great-circle distance stretched by a random detour factor.
+    void AddDistance(size_t from, size_t to) {
+        if (from == to || distances_.count({from, to}) || distances_.count({to, from})) {
+            return;
+        }
+        const double detour = uniform_real_distribution<double>(1.05, 1.6)(random_);
+        const int length = max(1, static_cast<int>(geo::ComputeDistance(stops_[from], stops_[to]) * detour));
+        distances_[{from, to}] = length;
+    }
+
+    // Routes walk from a random stop towards one of its close neighbours, so lines look local.
+    void GenerateBuses() {
+        uniform_int_distribution<int> route_length(settings_.min_route_length, settings_.max_route_length);
+        bernoulli_distribution is_roundtrip(settings_.roundtrip_share);
+        for (int i = 0; i < settings_.buses; ++i) {
+            Bus bus{"Bus "s + to_string(i), {}, is_roundtrip(random_)};
+            const int length = min(route_length(random_), settings_.stops);
+            bus.stops.push_back(RandomIndex(stops_.size()));
+            while (static_cast<int>(bus.stops.size()) < length) {
+                bus.stops.push_back(PickNextStop(bus.stops));
+            }
+            if (bus.is_roundtrip) {
+                bus.stops.push_back(bus.stops.front());
+            }
+            for (size_t k = 1; k < bus.stops.size(); ++k) {
+                AddDistance(bus.stops[k - 1], bus.stops[k]);
+            }
+            buses_.push_back(move(bus));
+        }
+    }
+
+    size_t PickNextStop(const vector<size_t>& route) {
+        constexpr int CANDIDATES = 8;
+        const geo::Coordinates& current = stops_[route.back()];
+        size_t best = RandomIndex(stops_.size());
+        while (best == route.back()) {
+            best = RandomIndex(stops_.size());
+        }
+        double best_distance = -1;
+        for (int attempt = 0; attempt < CANDIDATES; ++attempt) {
+            const size_t candidate = RandomIndex(stops_.size());
+            if (find(route.begin(), route.end(), candidate) != route.end()) {
+                continue;
+            }
+            const double distance = geo::ComputeDistance(current, stops_[candidate]);
+            if (best_distance < 0 || distance < best_distance) {
+                best = candidate;
+                best_distance = distance;
+            }
+        }
+        return best;
+    }
+
+    void GenerateExtraDistances() {
+        const auto extra_count = static_cast<size_t>(settings_.distance_density * stops_.size());
+        for (size_t i = 0; i < extra_count; ++i) {
+            AddDistance(RandomIndex(stops_.size()), RandomIndex(stops_.size()));
+        }
+    }
+
+    json::Node MakeStopRequest(size_t stop) const {
+        json::Dict road_distances;
+        for (auto iter = distances_.lower_bound({stop, 0}); iter != distances_.end() && iter->first.first == stop; ++iter) {
+            road_distances.emplace(stop_names_[iter->first.second], iter->second);
+        }
+        return json::Dict{
+            {"type"s, "Stop"s},
+            {"name"s, stop_names_[stop]},
+            {"latitude"s, stops_[stop].lat},
+            {"longitude"s, stops_[stop].lng},
+            {"road_distances"s, move(road_distances)},
+        };
+    }
+
+    json::Node MakeBusRequest(const Bus& bus) const {
+        json::Array stops;
+        for (const size_t stop : bus.stops) {
+            stops.push_back(stop_names_[stop]);
+        }
+        return json::Dict{
+            {"type"s, "Bus"s},
+            {"name"s, bus.name},
+            {"stops"s, move(stops)},
+            {"is_roundtrip"s, bus.is_roundtrip},
+        };
+    }
+
+    static json::Node MakeRenderSettings() {
+        return json::Dict{
+            {"width"s, 1200.0},
+            {"height"s, 1200.0},
+            {"padding"s, 50.0},
+            {"stop_radius"s, 3.0},
+            {"line_width"s, 4.0},
+            {"bus_label_font_size"s, 14},
+            {"bus_label_offset"s, json::Array{7.0, 15.0}},
+            {"stop_label_font_size"s, 10},
+            {"stop_label_offset"s, json::Array{7.0, -3.0}},
+            {"underlayer_color"s, json::Array{255, 255, 255, 0.85}},
+            {"underlayer_width"s, 3.0},
+            {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s, "blue"s}},
+        };
+    }
+
+    json::Node MakeStatRequests() {
+        discrete_distribution<int> request_type({
+            static_cast<double>(settings_.bus_weight), static_cast<double>(settings_.stop_weight),
+            static_cast<double>(settings_.route_weight), static_cast<double>(settings_.map_weight)});
+        json::Array requests;
+        requests.reserve(settings_.requests);
+        for (int id = 1; id <= settings_.requests; ++id) {
+            json::Dict request{{"id"s, id}};
+            switch (request_type(random_)) {
+                case 0:
+                    request.emplace("type"s, "Bus"s);
+                    request.emplace("name"s, buses_[RandomIndex(buses_.size())].name);
+                    break;
+                case 1:
+                    request.emplace("type"s, "Stop"s);
+                    request.emplace("name"s, stop_names_[RandomIndex(stop_names_.size())]);
+                    break;
+                case 2:
+                    request.emplace("type"s, "Route"s);
+                    request.emplace("from"s, stop_names_[RandomIndex(stop_names_.size())]);
+                    request.emplace("to"s, stop_names_[RandomIndex(stop_names_.size())]);
+                    break;
+                default:
+                    request.emplace("type"s, "Map"s);
+                    break;
+            }
+            requests.push_back(move(request));
+        }
+        return requests;
+    }
+};
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const GeneratorSettings settings = ParseArguments(argc, argv);
+        json::Print(json::Document{CityGenerator(settings).Generate()}, cout);
+        cout << '\n';
+    } catch (const exception& e) {
+        cerr << e.what() << '\n';
+        PrintUsage(cerr);
+        return 1;
+    }
+}
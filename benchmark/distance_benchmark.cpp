@@ -0,0 +1,95 @@
+// Compares the great-circle distance kernels on a random walk shaped like a bus route:
+//
+//   distance_benchmark [points] [runs]
+//
+// The scalar geo::ComputeDistance converts and takes the sine and cosine of both
+// latitudes for every pair; geo::ComputeDistances reads latitudes prepared once per
+// stop, as GetRouteInfo does. Both must give the same distances bit for bit, since
+// Bus responses print them.
+
+#include "../transport-catalogue/geo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+vector<geo::Coordinates> MakeRoute(size_t count) {
+    mt19937 generator(32);
+    uniform_real_distribution<double> step(-0.005, 0.005);
+    vector<geo::Coordinates> points;
+    points.reserve(count);
+    geo::Coordinates point{55.75, 37.62};
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back(point);
+        point.lat += step(generator);
+        point.lng += step(generator);
+    }
+    return points;
+}
+
+// The best of runs, in nanoseconds per computed distance.
+template <typename Kernel>
+double Measure(int runs, size_t pairs, Kernel kernel) {
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = Clock::now();
+        kernel();
+        const double nanoseconds = chrono::duration<double, nano>(Clock::now() - start).count() / pairs;
+        best = run == 0 ? nanoseconds : min(best, nanoseconds);
+    }
+    return best;
+}
+
+void PrintTime(const string& name, double nanoseconds) {
+    cout << left << setw(28) << name << right << fixed << setprecision(1) << setw(10) << nanoseconds << '\n';
+}
+
+}
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? max(2, stoi(argv[1])) : 1000;
+    const int runs = argc > 2 ? max(1, stoi(argv[2])) : 200;
+    const vector<geo::Coordinates> points = MakeRoute(count);
+    const size_t pairs = count - 1;
+
+    vector<double> scalar(pairs);
+    const double scalar_time = Measure(runs, pairs, [&] {
+        for (size_t i = 1; i < count; ++i) {
+            scalar[i - 1] = geo::ComputeDistance(points[i - 1], points[i]);
+        }
+    });
+
+    geo::CoordinatesSequence sequence;
+    sequence.Reserve(count);
+    const double prepare_time = Measure(1, pairs, [&] {
+        for (const geo::Coordinates& point : points) {
+            sequence.Add(geo::Prepare(point));
+        }
+    });
+    vector<double> batch(pairs);
+    const double batch_time = Measure(runs, pairs, [&] {
+        geo::ComputeDistances(sequence, batch.data());
+    });
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < pairs; ++i) {
+        mismatches += scalar[i] != batch[i];
+    }
+
+    cout << left << setw(28) << "kernel" << right << setw(10) << "ns/pair" << '\n';
+    PrintTime("ComputeDistance", scalar_time);
+    PrintTime("Prepare (once per stop)", prepare_time);
+    PrintTime("ComputeDistances", batch_time);
+    cout << "points: " << count << ", runs: " << runs << ", mismatches: " << mismatches << '\n';
+    return mismatches == 0 ? 0 : 1;
+}
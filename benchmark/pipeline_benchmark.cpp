@@ -0,0 +1,161 @@
+// Times every phase of the request pipeline on one input and prints a report:
+//
+//   city_generator --stops 2000 > city.json
+//   pipeline_benchmark city.json
+//
+// Reads standard input when no file is given. Responses are produced but discarded.
+
+#include "../transport-catalogue/json_reader.h"
+#include "../transport-catalogue/request_handler.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+double ToMilliseconds(Clock::duration duration) {
+    return chrono::duration<double, milli>(duration).count();
+}
+
+long GetPeakRssKilobytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+struct PhaseResult {
+    string name;
+    double milliseconds = 0.0;
+    size_t items = 0;
+    string unit;
+};
+
+class Report {
+public:
+    void Add(string name, Clock::duration duration, size_t items = 0, string unit = {}) {
+        phases_.push_back({move(name), ToMilliseconds(duration), items, move(unit)});
+    }
+
+    void Print(ostream& out) const {
+        out << left << setw(28) << "phase" << right << setw(12) << "time, ms" << setw(14) << "items"
+            << setw(18) << "throughput/s" << '\n';
+        out << fixed << setprecision(3);
+        for (const auto& phase : phases_) {
+            out << left << setw(28) << phase.name << right << setw(12) << phase.milliseconds;
+            if (phase.items > 0) {
+                const double per_second = phase.milliseconds > 0 ? phase.items * 1000.0 / phase.milliseconds : 0.0;
+                out << setw(14) << phase.items << setw(18) << setprecision(0) << per_second << setprecision(3)
+                    << ' ' << phase.unit;
+            }
+            out << '\n';
+        }
+        out << "peak RSS: " << GetPeakRssKilobytes() << " KB\n";
+    }
+
+private:
+    vector<PhaseResult> phases_;
+};
+
+string ReadInput(int argc, char** argv) {
+    ostringstream buffer;
+    if (argc > 1) {
+        ifstream file(argv[1], ios::binary);
+        if (!file) {
+            throw runtime_error("Cannot open "s + argv[1]);
+        }
+        buffer << file.rdbuf();
+    } else {
+        buffer << cin.rdbuf();
+    }
+    return buffer.str();
+}
+
+}
+
+int main(int argc, char** argv) {
+    Report report;
+    try {
+        const string input = ReadInput(argc, argv);
+
+        auto start = Clock::now();
+        istringstream input_stream(input);
+        JsonReader requests(input_stream);
+        report.Add("json::Load", Clock::now() - start, input.size(), "bytes");
+
+        transport_catalogue::TransportCatalogue catalogue;
+        start = Clock::now();
+        requests.PopulateCatalogue(catalogue);
+        report.Add("PopulateCatalogue", Clock::now() - start, requests.GetBaseRequests().AsArray().size(), "requests");
+
+        start = Clock::now();
+        const auto renderer = requests.FillRenderSettings(requests.GetRenderSettings().AsDict());
+        report.Add("FillRenderSettings", Clock::now() - start);
+
+        start = Clock::now();
+        const auto transport_router = requests.FillRoutingSettings(requests.GetRoutingSettings().AsDict(), catalogue);
+        transport_router.EnsureBuilt();
+        report.Add("TransportRouter total", Clock::now() - start);
+        const auto& build_stats = transport_router.GetBuildStats();
+        const auto to_duration = [](double milliseconds) {
+            return chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(milliseconds));
+        };
+        report.Add("  BuildGraph: stops", to_duration(build_stats.stops_ms));
+        report.Add("  BuildGraph: buses", to_duration(build_stats.buses_ms));
+        report.Add("  BuildGraph: graph", to_duration(build_stats.graph_ms));
+        report.Add("  Router construction", to_duration(build_stats.router_ms));
+
+        RequestHandler handler(renderer, catalogue, transport_router);
+
+        start = Clock::now();
+        const svg::Document svg_map = handler.RenderMap();
+        report.Add("RenderMap", Clock::now() - start);
+        start = Clock::now();
+        ostringstream svg_output;
+        svg_map.Render(svg_output);
+        report.Add("svg::Document::Render", Clock::now() - start, svg_output.str().size(), "bytes");
+
+        start = Clock::now();
+        const vector<StatRequest> stat_requests = requests.DecodeStatRequests(requests.GetStatRequests(), handler);
+        report.Add("decode stat requests", Clock::now() - start, stat_requests.size(), "requests");
+
+        map<string, pair<Clock::duration, size_t>> per_type;
+        json::Array responses;
+        responses.reserve(stat_requests.size());
+        for (const StatRequest& request : stat_requests) {
+            start = Clock::now();
+            responses.push_back(requests.ExecuteStatRequest(request, handler));
+            auto& [duration, count] = per_type[string{GetStatRequestTypeName(request.type)}];
+            duration += Clock::now() - start;
+            ++count;
+        }
+        for (const auto& [type, stats] : per_type) {
+            report.Add("stat requests: "s + type, stats.first, stats.second, "requests");
+        }
+
+        start = Clock::now();
+        const StatRequestPlan plan = PlanStatRequests(stat_requests);
+        const json::Array planned_responses = requests.ExecuteStatRequests(stat_requests, plan, handler);
+        report.Add("stat requests: planned", Clock::now() - start, plan.execution_order.size(), "unique");
+
+        start = Clock::now();
+        ostringstream json_output;
+        json::Print(json::Document{move(responses)}, json_output);
+        report.Add("json::Print", Clock::now() - start, json_output.str().size(), "bytes");
+    } catch (const exception& e) {
+        cerr << "Benchmark failed: " << e.what() << '\n';
+        return 1;
+    }
+    report.Print(cout);
+}
@@ -0,0 +1,94 @@
+// Measures catalogue loading from an already parsed document, the phase dominated by
+// json::Dict field lookups:
+//
+//   city_generator --stops 20000 > city.json
+//   populate_benchmark city.json [runs]
+//
+// Every run fills a fresh catalogue; the best and median run times are reported along
+// with the time of looking up the request fields alone.
+
+#include "../transport-catalogue/json_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+double ToMilliseconds(Clock::duration duration) {
+    return chrono::duration<double, milli>(duration).count();
+}
+
+void PrintTimes(const string& name, vector<double> milliseconds, size_t items) {
+    sort(milliseconds.begin(), milliseconds.end());
+    const double best = milliseconds.front();
+    const double median = milliseconds[milliseconds.size() / 2];
+    cout << left << setw(24) << name << right << fixed << setprecision(3)
+         << setw(12) << best << setw(12) << median
+         << setw(14) << setprecision(0) << (best > 0 ? items * 1000.0 / best : 0.0) << '\n';
+}
+
+// Reads the fields PopulateCatalogue reads, without building anything.
+size_t LookUpFields(const json::Array& base_requests) {
+    size_t checksum = 0;
+    for (const auto& request : base_requests) {
+        const auto& request_map = request.AsDict();
+        const string_view type = request_map.at("type").AsString();
+        checksum += request_map.at("name").AsString().size();
+        if (type == "Stop") {
+            checksum += static_cast<size_t>(request_map.at("latitude").AsDouble());
+            checksum += static_cast<size_t>(request_map.at("longitude").AsDouble());
+            checksum += request_map.at("road_distances").AsDict().size();
+        } else if (type == "Bus") {
+            checksum += request_map.at("is_roundtrip").AsBool();
+            checksum += request_map.at("stops").AsArray().size();
+        }
+    }
+    return checksum;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: populate_benchmark input.json [runs]\n";
+        return 1;
+    }
+    try {
+        const int runs = argc > 2 ? max(1, stoi(argv[2])) : 10;
+        JsonReader requests = JsonReader::FromFile(argv[1]);
+        const json::Array& base_requests = requests.GetBaseRequests().AsArray();
+
+        vector<double> populate_times;
+        vector<double> lookup_times;
+        size_t checksum = 0;
+        for (int run = 0; run < runs; ++run) {
+            auto start = Clock::now();
+            checksum += LookUpFields(base_requests);
+            lookup_times.push_back(ToMilliseconds(Clock::now() - start));
+
+            transport_catalogue::TransportCatalogue catalogue;
+            start = Clock::now();
+            requests.PopulateCatalogue(catalogue);
+            populate_times.push_back(ToMilliseconds(Clock::now() - start));
+            checksum += catalogue.GetAllStops().size();
+        }
+
+        cout << left << setw(24) << "phase" << right << setw(12) << "best, ms" << setw(12) << "median, ms"
+             << setw(14) << "requests/s" << '\n';
+        PrintTimes("field lookups", lookup_times, base_requests.size());
+        PrintTimes("PopulateCatalogue", populate_times, base_requests.size());
+        cout << "runs: " << runs << ", checksum: " << checksum << '\n';
+    } catch (const exception& e) {
+        cerr << "Benchmark failed: " << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,111 @@
+#include "test_framework.h"
+#include "transport_catalogue.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// A - B - C on one meridian, a linear bus over them and a roundtrip A - B - A.
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue) {
+    catalogue.AddStop("A"sv, {55.0, 37.0});
+    catalogue.AddStop("B"sv, {55.01, 37.0});
+    catalogue.AddStop("C"sv, {55.02, 37.0});
+    catalogue.AddStop("Lonely"sv, {56.0, 38.0});
+    catalogue.SetDistance("A"sv, "B"sv, 1200);
+    catalogue.SetDistance("B"sv, "A"sv, 1300);
+    catalogue.SetDistance("B"sv, "C"sv, 1500);
+    catalogue.AddBus("linear"sv, {"A"sv, "B"sv, "C"sv}, false);
+    catalogue.AddBus("circle"sv, {"A"sv, "B"sv, "A"sv}, true);
+}
+
+std::vector<std::string_view> ToVector(transport_catalogue::TransportCatalogue::BusNamesRange range) {
+    return {range.begin(), range.end()};
+}
+
+void TestFindBeforeAndAfterFinalize() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    ASSERT(catalogue.FindStop("B"sv) != nullptr);
+    ASSERT(catalogue.FindStop("D"sv) == nullptr);
+    catalogue.Finalize();
+
+    const domain::Stop* stop = catalogue.FindStop("B"sv);
+    ASSERT(stop != nullptr);
+    ASSERT_EQUAL(stop->name, "B"sv);
+    ASSERT_EQUAL(stop->coordinates.lat, 55.01);
+    ASSERT(catalogue.FindStop("D"sv) == nullptr);
+    ASSERT(catalogue.FindStop(""sv) == nullptr);
+
+    const domain::Bus* bus = catalogue.FindBus("linear"sv);
+    ASSERT(bus != nullptr);
+    ASSERT(!bus->is_roundtrip);
+    ASSERT(catalogue.FindBus("A"sv) == nullptr);
+}
+
+void TestDistances() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    const domain::Stop* a = catalogue.FindStop("A"sv);
+    const domain::Stop* b = catalogue.FindStop("B"sv);
+    const domain::Stop* c = catalogue.FindStop("C"sv);
+    ASSERT_EQUAL(catalogue.GetDistance(a, b), 1200);
+    ASSERT_EQUAL(catalogue.GetDistance(b, a), 1300);
+    // Only one direction given: the other falls back to it.
+    ASSERT_EQUAL(catalogue.GetDistance(c, b), 1500);
+    ASSERT_EQUAL(catalogue.GetDistance(a, c), 0);
+}
+
+void TestBusesToStop() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    catalogue.Finalize();
+    ASSERT(ToVector(catalogue.GetBusesToStop("A"sv)) == (std::vector{"circle"sv, "linear"sv}));
+    ASSERT(ToVector(catalogue.GetBusesToStop("C"sv)) == (std::vector{"linear"sv}));
+    ASSERT(ToVector(catalogue.GetBusesToStop("Lonely"sv)).empty());
+}
+
+void TestRouteInfo() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    catalogue.Finalize();
+
+    const domain::RouteInfo linear = catalogue.GetRouteInfo(catalogue.FindBus("linear"sv));
+    ASSERT_EQUAL(linear.stops_number, 5u);
+    ASSERT_EQUAL(linear.unique_stops_number, 3u);
+    // There: 1200 + 1500, back: 1500 + 1300.
+    ASSERT_EQUAL(linear.route_length, 5500);
+    const double there = geo::ComputeDistance(geo::Coordinates{55.0, 37.0}, geo::Coordinates{55.02, 37.0});
+    ASSERT(std::abs(linear.distance - 2 * there) < 1e-6 * there);
+    ASSERT(std::abs(linear.curvature - 5500 / linear.distance) < 1e-9);
+
+    const domain::RouteInfo circle = catalogue.GetRouteInfo(catalogue.FindBus("circle"sv));
+    ASSERT_EQUAL(circle.stops_number, 3u);
+    ASSERT_EQUAL(circle.unique_stops_number, 2u);
+    ASSERT_EQUAL(circle.route_length, 2500);
+}
+
+void TestStopNameSearchNeedsFinalize() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    ASSERT_THROWS(catalogue.GetStopNameSearch(), std::logic_error);
+    catalogue.Finalize();
+    const auto matches = catalogue.GetStopNameSearch().Search("Lo"sv, 0, 10);
+    ASSERT_EQUAL(matches.size(), 1u);
+    ASSERT_EQUAL(matches.front().name, "Lonely"sv);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestFindBeforeAndAfterFinalize);
+    RUN_TEST(runner, TestDistances);
+    RUN_TEST(runner, TestBusesToStop);
+    RUN_TEST(runner, TestRouteInfo);
+    RUN_TEST(runner, TestStopNameSearchNeedsFinalize);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include "catalogue_versions.h"
+#include "test_framework.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+const std::string DATA_DIR = TC_TEST_DATA_DIR;
+
+// Harbour, Market, Museum and Station, with the roundtrip bus 14 and the linear bus 7.
+std::unique_ptr<catalogue_versions::Snapshot> LoadSnapshot(const std::string& file_name = "late_settings.json"s) {
+    std::ifstream input(DATA_DIR + "/"s + file_name);
+    JsonReader reader(input);
+    return catalogue_versions::Snapshot::Load(reader);
+}
+
+std::string GetExtraStopName(uint64_t version) {
+    return "Extra "s + std::to_string(version);
+}
+
+// Version n + 1 adds the stop "Extra n + 1" and moves the bus "extra" to end there.
+catalogue_versions::CatalogueEdit MakeExtraStopEdit(uint64_t version) {
+    const std::string name = GetExtraStopName(version + 1);
+    catalogue_versions::CatalogueEdit edit;
+    edit.stops.push_back({name, {43.59 + 0.001 * static_cast<double>(version), 39.72}});
+    edit.distances.emplace_back("Market"s, name, 500);
+    edit.buses.push_back({"extra"s, {"Market"s, name}, false});
+    return edit;
+}
+
+void TestApplyEdit() {
+    const auto first = LoadSnapshot();
+    ASSERT_EQUAL(first->GetVersion(), 1u);
+    const domain::Stop* old_museum = first->GetCatalogue().FindStop("Museum"sv);
+
+    catalogue_versions::CatalogueEdit edit;
+    edit.stops.push_back({"Museum"s, {43.5, 39.7}});
+    edit.stops.push_back({"Pier"s, {43.6, 39.75}});
+    edit.distances.emplace_back("Market"s, "Museum"s, 1000);
+    edit.distances.emplace_back("Station"s, "Pier"s, 700);
+    edit.buses.push_back({"7"s, {"Market"s, "Station"s, "Pier"s}, false});
+    edit.removed_buses.push_back("14"s);
+    const auto second = first->Apply(edit);
+
+    const transport_catalogue::TransportCatalogue& catalogue = second->GetCatalogue();
+    ASSERT_EQUAL(second->GetVersion(), 2u);
+    const domain::Stop* museum = catalogue.FindStop("Museum"sv);
+    ASSERT_EQUAL(museum->id, old_museum->id);
+    ASSERT_EQUAL(museum->coordinates.lat, 43.5);
+    ASSERT(catalogue.FindStop("Pier"sv) != nullptr);
+    ASSERT_EQUAL(catalogue.GetDistance(catalogue.FindStop("Market"sv), museum), 1000);
+    ASSERT_EQUAL(catalogue.GetDistance(catalogue.FindStop("Market"sv), catalogue.FindStop("Station"sv)), 1500);
+    ASSERT(catalogue.FindBus("14"sv) == nullptr);
+    ASSERT_EQUAL(catalogue.FindBus("7"sv)->stops.size(), 3u);
+    ASSERT(second->GetRouter().IsBuilt());
+    ASSERT(second->GetRouter().GetRoute("Harbour"sv, "Pier"sv) == std::nullopt);
+    ASSERT(second->GetRouter().GetRoute("Market"sv, "Pier"sv).has_value());
+
+    // The previous version is unchanged.
+    const transport_catalogue::TransportCatalogue& old_catalogue = first->GetCatalogue();
+    ASSERT_EQUAL(old_museum->coordinates.lat, 43.581969);
+    ASSERT(old_catalogue.FindStop("Pier"sv) == nullptr);
+    ASSERT_EQUAL(old_catalogue.GetDistance(old_catalogue.FindStop("Market"sv), old_museum), 890);
+    ASSERT(old_catalogue.FindBus("14"sv) != nullptr);
+    ASSERT_EQUAL(old_catalogue.FindBus("7"sv)->stops.size(), 2u);
+}
+
+// The repeated Market and bus 7 replace the earlier ones, whose ids stay taken.
+void TestApplyWithRepeatedNames() {
+    const auto first = LoadSnapshot("repeated_names.json"s);
+    const transport_catalogue::TransportCatalogue& old_catalogue = first->GetCatalogue();
+    ASSERT_EQUAL(old_catalogue.GetStopCount(), 4u);
+    ASSERT_EQUAL(old_catalogue.GetBusCount(), 3u);
+
+    catalogue_versions::CatalogueEdit edit;
+    edit.stops.push_back({"Pier"s, {43.6, 39.75}});
+    const auto second = first->Apply(edit);
+
+    const transport_catalogue::TransportCatalogue& catalogue = second->GetCatalogue();
+    ASSERT_EQUAL(catalogue.GetStopCount(), 4u);
+    ASSERT_EQUAL(catalogue.GetBusCount(), 2u);
+    const domain::Stop* market = catalogue.FindStop("Market"sv);
+    ASSERT_EQUAL(market->coordinates.lat, 43.587795);
+    ASSERT_EQUAL(catalogue.FindBus("7"sv)->stops.front(), market);
+    ASSERT_EQUAL(catalogue.FindBus("14"sv)->stops[1], market);
+    // Road distances are the ones the last stops of each name had.
+    for (const auto& [from, to] : {std::pair{"Market"sv, "Harbour"sv}, {"Harbour"sv, "Market"sv}, {"Market"sv, "Station"sv}}) {
+        ASSERT_EQUAL(catalogue.GetDistance(catalogue.FindStop(from), catalogue.FindStop(to)),
+                     old_catalogue.GetDistance(old_catalogue.FindStop(from), old_catalogue.FindStop(to)));
+    }
+    ASSERT(second->GetRouter().GetRoute("Harbour"sv, "Station"sv).has_value());
+}
+
+void TestPublishWaitsForReaders() {
+    catalogue_versions::CatalogueVersions versions(LoadSnapshot());
+    std::future<uint64_t> published;
+    {
+        const auto guard = versions.Read();
+        published = versions.PublishAsync(MakeExtraStopEdit(1));
+        ASSERT(published.wait_for(100ms) == std::future_status::timeout);
+        // The writer has swapped in version 2, but the pinned version 1 stays alive.
+        ASSERT_EQUAL(versions.GetVersion(), 2u);
+        ASSERT_EQUAL(guard->GetVersion(), 1u);
+        ASSERT(guard->GetCatalogue().FindStop("Harbour"sv) != nullptr);
+        ASSERT(guard->GetCatalogue().FindStop(GetExtraStopName(2)) == nullptr);
+    }
+    ASSERT_EQUAL(published.get(), 2u);
+    ASSERT_EQUAL(versions.Publish(MakeExtraStopEdit(2)), 3u);
+}
+
+// Readers check every version they pin for the stops of all the edits published up
+// to it, while a writer keeps publishing; -fsanitize=thread also checks the handoff.
+void TestConcurrentReadersAndWriter() {
+    const uint64_t last_version = 30;
+    catalogue_versions::CatalogueVersions versions(LoadSnapshot());
+    std::atomic<bool> is_done = false;
+    std::atomic<int> failures = 0;
+    std::atomic<size_t> reads = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            uint64_t seen_version = 0;
+            while (!is_done.load()) {
+                const auto snapshot = versions.Read();
+                const uint64_t version = snapshot->GetVersion();
+                const transport_catalogue::TransportCatalogue& catalogue = snapshot->GetCatalogue();
+                bool is_consistent = version >= seen_version && version <= last_version
+                                     && catalogue.FindStop(GetExtraStopName(version + 1)) == nullptr;
+                for (uint64_t extra = 2; extra <= version; ++extra) {
+                    is_consistent = is_consistent && catalogue.FindStop(GetExtraStopName(extra)) != nullptr;
+                }
+                if (version > 1) {
+                    const domain::Bus* bus = catalogue.FindBus("extra"sv);
+                    is_consistent = is_consistent && bus && bus->stops.back()->name == GetExtraStopName(version)
+                                    && snapshot->GetRouter().GetRoute("Harbour"sv, GetExtraStopName(version)).has_value();
+                }
+                if (!is_consistent) {
+                    ++failures;
+                }
+                seen_version = version;
+                ++reads;
+            }
+        });
+    }
+
+    for (uint64_t version = 1; version < last_version; ++version) {
+        const uint64_t published = version % 2 == 0 ? versions.PublishAsync(MakeExtraStopEdit(version)).get()
+                                                    : versions.Publish(MakeExtraStopEdit(version));
+        ASSERT_EQUAL(published, version + 1);
+    }
+    is_done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQUAL(failures.load(), 0);
+    ASSERT(reads.load() > 0);
+    ASSERT_EQUAL(versions.GetVersion(), last_version);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestApplyEdit);
+    RUN_TEST(runner, TestApplyWithRepeatedNames);
+    RUN_TEST(runner, TestPublishWaitsForReaders);
+    RUN_TEST(runner, TestConcurrentReadersAndWriter);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "city_registry.h"
+#include "test_framework.h"
+
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+const std::string DATA_DIR = TC_TEST_DATA_DIR;
+
+json::Dict MakeRequest(int id, std::string_view region, std::string_view type) {
+    json::Dict request{{"id"s, id}, {"region"s, std::string{region}}, {"type"s, std::string{type}}};
+    if (type == "Route"sv) {
+        request["from"s] = json::Node{"Harbour"s};
+        request["to"s] = json::Node{"Station"s};
+    } else if (type == "Bus"sv) {
+        request["name"s] = json::Node{"14"s};
+    }
+    return request;
+}
+
+std::string_view GetErrorMessage(const std::optional<json::Node>& response) {
+    const json::Dict& response_map = response->AsDict();
+    const auto error_iter = response_map.find("error_message"sv);
+    return error_iter != response_map.end() ? error_iter->second.AsString() : ""sv;
+}
+
+void TestUnknownRegion() {
+    city_registry::CityRegistry registry;
+    registry.Register("full"s, DATA_DIR + "/late_settings.json"s);
+    ASSERT(!registry.Acquire("nowhere"sv));
+    ASSERT_EQUAL(GetErrorMessage(registry.ProcessStatRequest(MakeRequest(1, "nowhere"sv, "Bus"sv))), "not found"sv);
+    ASSERT_EQUAL(registry.GetLoadedCount(), 0u);
+}
+
+void TestMissingSettings() {
+    city_registry::CityRegistry registry;
+    registry.Register("bare"s, DATA_DIR + "/no_settings.json"s);
+    registry.Register("full"s, DATA_DIR + "/late_settings.json"s);
+
+    ASSERT_EQUAL(GetErrorMessage(registry.ProcessStatRequest(MakeRequest(1, "bare"sv, "Map"sv))), "no render_settings"sv);
+    ASSERT_EQUAL(GetErrorMessage(registry.ProcessStatRequest(MakeRequest(2, "bare"sv, "Route"sv))), "no routing_settings"sv);
+    const auto bus = registry.ProcessStatRequest(MakeRequest(3, "bare"sv, "Bus"sv));
+    ASSERT_EQUAL(bus->AsDict().at("stop_count"sv).AsInt(), 4);
+
+    const auto map = registry.ProcessStatRequest(MakeRequest(4, "full"sv, "Map"sv));
+    ASSERT(map->AsDict().count("map"sv) > 0);
+    const auto route = registry.ProcessStatRequest(MakeRequest(5, "full"sv, "Route"sv));
+    ASSERT(route->AsDict().count("total_time"sv) > 0);
+}
+
+void TestEvictionKeepsHeldCities() {
+    // Any loaded region is over a one-byte budget, so only the latest one stays loaded.
+    city_registry::CityRegistry registry(1);
+    registry.Register("first"s, DATA_DIR + "/late_settings.json"s);
+    registry.Register("second"s, DATA_DIR + "/no_settings.json"s);
+
+    const auto first = registry.Acquire("first"sv);
+    ASSERT_EQUAL(registry.GetLoadedCount(), 1u);
+    const auto second = registry.Acquire("second"sv);
+    ASSERT_EQUAL(registry.GetLoadedCount(), 1u);
+    ASSERT(registry.Acquire("second"sv) == second);
+
+    // The evicted city stays usable by whoever still holds it.
+    const auto response = first->ProcessStatRequest(MakeRequest(1, "first"sv, "Bus"sv));
+    ASSERT_EQUAL(response->AsDict().at("stop_count"sv).AsInt(), 4);
+}
+
+// Memory is measured while other threads build the router and the stop name search.
+// Nothing else orders the threads, so -fsanitize=thread reports any unguarded read.
+void TestMemoryUsageWhileBuilding() {
+    city_registry::CityRegistry registry;
+    registry.Register("full"s, DATA_DIR + "/late_settings.json"s);
+    const auto city = registry.Acquire("full"sv);
+    const size_t loaded_bytes = city->GetMemoryUsage().GetTotalBytes();
+
+    std::atomic<bool> is_done = false;
+    std::thread measurer([&city, &is_done] {
+        while (!is_done.load()) {
+            city->GetMemoryUsage();
+        }
+    });
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+        workers.emplace_back([&city, i] {
+            city->ProcessStatRequest(MakeRequest(i, "full"sv, "Route"sv));
+            json::Dict search = MakeRequest(i, "full"sv, "StopSearch"sv);
+            search["prefix"s] = json::Node{"M"s};
+            city->ProcessStatRequest(search);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    is_done = true;
+    measurer.join();
+
+    ASSERT(city->IsRouterBuilt());
+    ASSERT(city->GetMemoryUsage().GetTotalBytes() > loaded_bytes);
+}
+
+void TestManifestMemoryBudget() {
+    const auto registry = city_registry::LoadManifest(DATA_DIR + "/budget_manifest.json"s);
+    ASSERT_EQUAL(registry->GetMemoryBudget(), 3u * 1024 * 1024);
+    ASSERT(registry->Acquire("full"sv));
+    ASSERT_EQUAL(city_registry::LoadManifest(DATA_DIR + "/unlimited_manifest.json"s)->GetMemoryBudget(),
+                 std::numeric_limits<size_t>::max());
+    ASSERT_THROWS(city_registry::LoadManifest(DATA_DIR + "/negative_budget_manifest.json"s), std::invalid_argument);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestUnknownRegion);
+    RUN_TEST(runner, TestMissingSettings);
+    RUN_TEST(runner, TestEvictionKeepsHeldCities);
+    RUN_TEST(runner, TestMemoryUsageWhileBuilding);
+    RUN_TEST(runner, TestManifestMemoryBudget);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+# Answers INPUT with transport_catalogue in batch mode and then RUNS times with --pipeline,
+# failing unless every pipelined output is byte-identical to the batch one. Differing
+# outputs are left in WORK_DIR.
+#
+#   cmake -DPROGRAM=<transport_catalogue> -DINPUT=<input.json> -DWORK_DIR=<dir> [-DRUNS=N]
+#         [-DGENERATOR=<city_generator> "-DGENERATOR_ARGS=--stops;100"] [-DEXPECT_ERROR=ON]
+#         -P compare_pipeline.cmake
+#
+# With GENERATOR, INPUT is first written by running it with GENERATOR_ARGS. With
+# EXPECT_ERROR, INPUT is one --pipeline must refuse rather than answer unlike batch mode,
+# and the script fails unless --pipeline exits nonzero.
+
+foreach(variable PROGRAM INPUT WORK_DIR)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED RUNS)
+    set(RUNS 3)
+endif()
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+if(DEFINED GENERATOR)
+    execute_process(COMMAND ${GENERATOR} ${GENERATOR_ARGS} OUTPUT_FILE ${INPUT} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${GENERATOR} failed: ${result}")
+    endif()
+endif()
+
+if(EXPECT_ERROR)
+    execute_process(COMMAND ${PROGRAM} --pipeline INPUT_FILE ${INPUT} OUTPUT_QUIET ERROR_VARIABLE error
+                    RESULT_VARIABLE result)
+    if(result EQUAL 0)
+        message(FATAL_ERROR "--pipeline accepted ${INPUT}")
+    endif()
+    message(STATUS "--pipeline refused ${INPUT}: ${error}")
+    return()
+endif()
+
+# Outputs are captured through pipes, as in a shell pipeline.
+execute_process(COMMAND ${PROGRAM} INPUT_FILE ${INPUT} OUTPUT_VARIABLE expected RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Batch mode failed on ${INPUT}: ${result}")
+endif()
+
+get_filename_component(name ${INPUT} NAME_WE)
+foreach(run RANGE 1 ${RUNS})
+    execute_process(COMMAND ${PROGRAM} --pipeline INPUT_FILE ${INPUT} OUTPUT_VARIABLE actual RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "--pipeline failed on ${INPUT}: ${result}")
+    endif()
+    if(NOT actual STREQUAL expected)
+        file(WRITE ${WORK_DIR}/${name}.batch.json "${expected}")
+        file(WRITE ${WORK_DIR}/${name}.pipeline.json "${actual}")
+        message(FATAL_ERROR "Run ${run} of --pipeline differs from batch mode, see ${WORK_DIR}/${name}.*.json")
+    endif()
+endforeach()
@@ -0,0 +1,123 @@
+#include "instrumentation.h"
+#include "json.h"
+#include "test_framework.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// The profiler is process-wide, so the tests run in order: disabled, enabled without
+// tracing, then tracing.
+json::Node LoadReport(void (instrumentation::Profiler::*print)(std::ostream&) const) {
+    std::stringstream report;
+    (instrumentation::Profiler::Instance().*print)(report);
+    return json::Load(report).GetRoot();
+}
+
+const json::Dict* FindPhase(const json::Node& report, std::string_view name) {
+    for (const auto& phase : report.AsDict().at("phases"sv).AsArray()) {
+        if (phase.AsDict().at("name"sv).AsString() == name) {
+            return &phase.AsDict();
+        }
+    }
+    return nullptr;
+}
+
+size_t CountTraceEvents(std::string_view name) {
+    const json::Node trace = LoadReport(&instrumentation::Profiler::PrintTrace);
+    size_t count = 0;
+    for (const auto& event : trace.AsDict().at("traceEvents"sv).AsArray()) {
+        count += event.AsDict().at("name"sv).AsString() == name;
+    }
+    return count;
+}
+
+void TestHistogramMerge() {
+    instrumentation::LatencyHistogram all;
+    instrumentation::LatencyHistogram first;
+    instrumentation::LatencyHistogram second;
+    for (int i = 1; i <= 100; ++i) {
+        const auto duration = std::chrono::microseconds(i * i);
+        all.Add(duration);
+        (i % 3 == 0 ? first : second).Add(duration);
+    }
+    first.Merge(second);
+    ASSERT_EQUAL(first.GetCount(), all.GetCount());
+    ASSERT_EQUAL(first.GetTotalMs(), all.GetTotalMs());
+    ASSERT_EQUAL(first.GetMaxMs(), all.GetMaxMs());
+    for (const double quantile : {0.0, 0.5, 0.9, 0.99, 1.0}) {
+        ASSERT_EQUAL(first.GetPercentileMs(quantile), all.GetPercentileMs(quantile));
+    }
+}
+
+void TestDisabledRecordsNothing() {
+    {
+        instrumentation::ScopedTimer timer("Disabled phase"sv);
+    }
+    const json::Node report = LoadReport(&instrumentation::Profiler::PrintJsonReport);
+    ASSERT(report.AsDict().at("phases"sv).AsArray().empty());
+    ASSERT(report.AsDict().at("requests"sv).AsDict().empty());
+}
+
+void TestMergesThreads() {
+    instrumentation::Profiler::Instance().Enable(false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            instrumentation::ScopedTimer timer("Worker"sv);
+            for (int request = 0; request < 500; ++request) {
+                instrumentation::ScopedTimer request_timer("Bus"sv, instrumentation::EventKind::REQUEST);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    {
+        instrumentation::ScopedTimer timer("Main"sv);
+    }
+
+    const json::Node report = LoadReport(&instrumentation::Profiler::PrintJsonReport);
+    ASSERT_EQUAL(report.AsDict().at("requests"sv).AsDict().at("Bus"sv).AsDict().at("count"sv).AsInt(), 2000);
+    ASSERT_EQUAL(FindPhase(report, "Worker"sv)->at("calls"sv).AsInt(), 4);
+    // Phases are listed in order of their first start.
+    const json::Array& phases = report.AsDict().at("phases"sv).AsArray();
+    ASSERT_EQUAL(phases.size(), 2u);
+    ASSERT_EQUAL(phases.back().AsDict().at("name"sv).AsString(), "Main"sv);
+    // Without tracing, no trace events are kept.
+    ASSERT(LoadReport(&instrumentation::Profiler::PrintTrace).AsDict().at("traceEvents"sv).AsArray().empty());
+}
+
+void TestTracing() {
+    instrumentation::Profiler::Instance().Enable(true);
+    std::thread worker([] {
+        instrumentation::ScopedTimer timer("Traced worker"sv);
+    });
+    worker.join();
+    {
+        instrumentation::ScopedTimer timer("Traced main"sv);
+        instrumentation::ScopedTimer request_timer("Stop"sv, instrumentation::EventKind::REQUEST);
+    }
+    ASSERT_EQUAL(CountTraceEvents("Traced worker"sv), 1u);
+    ASSERT_EQUAL(CountTraceEvents("Traced main"sv), 1u);
+    ASSERT_EQUAL(CountTraceEvents("Stop"sv), 1u);
+    ASSERT_EQUAL(CountTraceEvents("Worker"sv), 0u);
+    const json::Node report = LoadReport(&instrumentation::Profiler::PrintJsonReport);
+    ASSERT_EQUAL(FindPhase(report, "Traced main"sv)->at("calls"sv).AsInt(), 1);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestHistogramMerge);
+    RUN_TEST(runner, TestDisabledRecordsNothing);
+    RUN_TEST(runner, TestMergesThreads);
+    RUN_TEST(runner, TestTracing);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
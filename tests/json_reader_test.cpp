@@ -0,0 +1,350 @@
+#include "json_reader.h"
+#include "test_framework.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+std::string GetStopName(int row, int column) {
+    return "S"s + std::to_string(row) + "-"s + std::to_string(column);
+}
+
+// A GRID x GRID square of stops 1 km apart, a linear bus along every row and column.
+constexpr int GRID = 12;
+
+json::Document MakeGridInput(std::optional<int> default_timeout_ms = std::nullopt) {
+    json::Array base_requests;
+    for (int row = 0; row < GRID; ++row) {
+        for (int column = 0; column < GRID; ++column) {
+            json::Dict distances;
+            if (column + 1 < GRID) {
+                distances[GetStopName(row, column + 1)] = json::Node{1000};
+            }
+            if (row + 1 < GRID) {
+                distances[GetStopName(row + 1, column)] = json::Node{1000};
+            }
+            base_requests.push_back(json::Dict{{"type"s, "Stop"s}, {"name"s, GetStopName(row, column)},
+                                               {"latitude"s, 55.0 + 0.009 * row}, {"longitude"s, 37.0 + 0.016 * column},
+                                               {"road_distances"s, std::move(distances)}});
+        }
+    }
+    for (int line = 0; line < GRID; ++line) {
+        json::Array row_stops;
+        json::Array column_stops;
+        for (int i = 0; i < GRID; ++i) {
+            row_stops.push_back(GetStopName(line, i));
+            column_stops.push_back(GetStopName(i, line));
+        }
+        base_requests.push_back(json::Dict{{"type"s, "Bus"s}, {"name"s, "R"s + std::to_string(line)},
+                                           {"stops"s, std::move(row_stops)}, {"is_roundtrip"s, false}});
+        base_requests.push_back(json::Dict{{"type"s, "Bus"s}, {"name"s, "C"s + std::to_string(line)},
+                                           {"stops"s, std::move(column_stops)}, {"is_roundtrip"s, false}});
+    }
+
+    json::Dict render_settings{
+        {"width"s, 600.0}, {"height"s, 400.0}, {"padding"s, 50.0}, {"stop_radius"s, 5.0}, {"line_width"s, 14.0},
+        {"bus_label_font_size"s, 20}, {"bus_label_offset"s, json::Array{7.0, 15.0}},
+        {"stop_label_font_size"s, 18}, {"stop_label_offset"s, json::Array{7.0, -3.0}},
+        {"underlayer_color"s, json::Array{255, 255, 255, 0.85}}, {"underlayer_width"s, 3.0},
+        {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s}}};
+    json::Dict root{{"base_requests"s, std::move(base_requests)},
+                    {"render_settings"s, std::move(render_settings)},
+                    {"routing_settings"s, json::Dict{{"bus_wait_time"s, 2}, {"bus_velocity"s, 30.0}}},
+                    {"stat_requests"s, json::Array{}}};
+    if (default_timeout_ms) {
+        root["request_settings"s] = json::Dict{{"timeout_ms"s, *default_timeout_ms}};
+    }
+    return json::Document{std::move(root)};
+}
+
+// Everything a JsonReader needs to answer stat requests, as main builds it.
+struct City {
+    explicit City(json::Document document)
+        : reader(std::move(document)) {
+        reader.PopulateCatalogue(catalogue);
+    }
+
+    JsonReader reader;
+    transport_catalogue::TransportCatalogue catalogue;
+    const map_renderer::MapRenderer renderer = reader.MakeRenderer();
+    const transport_router::TransportRouter router{reader.MakeRoutingSettings(), catalogue};
+    const RequestHandler handler{renderer, catalogue, router};
+
+    StatRequest Decode(const json::Dict& request_map) const {
+        return *reader.DecodeStatRequest(request_map, handler);
+    }
+};
+
+json::Dict MakeRoute(int id, const std::string& from, const std::string& to) {
+    return {{"id"s, id}, {"type"s, "Route"s}, {"from"s, from}, {"to"s, to}};
+}
+
+json::Dict MakeCornerRoute(int id) {
+    return MakeRoute(id, GetStopName(0, 0), GetStopName(GRID - 1, GRID - 1));
+}
+
+std::string_view GetErrorMessage(const json::Node& response) {
+    const auto error_iter = response.AsDict().find("error_message"sv);
+    return error_iter != response.AsDict().end() ? error_iter->second.AsString() : ""sv;
+}
+
+void TestDeadline() {
+    const cancellation::Deadline unlimited;
+    ASSERT(!unlimited.IsExpired());
+    for (int i = 0; i < 1000; ++i) {
+        unlimited.Check();
+    }
+    unlimited.ThrowIfExpired();
+
+    const cancellation::Deadline distant(std::chrono::hours(1));
+    ASSERT(!distant.IsExpired());
+    distant.ThrowIfExpired();
+
+    const cancellation::Deadline expired(cancellation::Deadline::Clock::duration::zero());
+    ASSERT(expired.IsExpired());
+    ASSERT_THROWS(expired.ThrowIfExpired(), cancellation::DeadlineExceeded);
+    // The clock is only read every so many checks, but a loop does get stopped.
+    ASSERT_THROWS([&expired] {
+        for (int i = 0; i < 1000; ++i) {
+            expired.Check();
+        }
+    }(), cancellation::DeadlineExceeded);
+}
+
+void TestExpiredBudgetAnswersTimeout() {
+    const City city(MakeGridInput());
+    const cancellation::Deadline expired(cancellation::Deadline::Clock::duration::zero());
+    json::Dict pareto = MakeCornerRoute(2);
+    pareto["pareto"s] = json::Node{true};
+    json::Dict alternatives = MakeCornerRoute(3);
+    alternatives["alternatives"s] = json::Node{5};
+    const json::Dict map{{"id"s, 1}, {"type"s, "Map"s}};
+    for (const json::Dict& request_map : {map, pareto, alternatives}) {
+        const json::Node response = city.reader.ExecuteStatRequest(city.Decode(request_map), city.handler, expired);
+        ASSERT_EQUAL(GetErrorMessage(response), "timeout"sv);
+        ASSERT_EQUAL(response.AsDict().at("request_id"sv).AsInt(), request_map.at("id"sv).AsInt());
+        ASSERT_EQUAL(response.AsDict().size(), 2u);
+    }
+
+    // Bus, Stop and best-route requests are answered from precomputed data, budget or not.
+    const json::Dict bus{{"id"s, 4}, {"type"s, "Bus"s}, {"name"s, "R0"s}};
+    const json::Dict stop{{"id"s, 5}, {"type"s, "Stop"s}, {"name"s, GetStopName(0, 0)}};
+    for (const json::Dict& request_map : {bus, stop, MakeCornerRoute(6)}) {
+        const json::Node response = city.reader.ExecuteStatRequest(city.Decode(request_map), city.handler, expired);
+        ASSERT_EQUAL(GetErrorMessage(response), ""sv);
+    }
+}
+
+void TestDefaultAndPerRequestTimeout() {
+    const City unlimited_city(MakeGridInput());
+    ASSERT_EQUAL(unlimited_city.Decode(MakeCornerRoute(1)).timeout_ms, 0);
+
+    const City city(MakeGridInput(50));
+    ASSERT_EQUAL(city.Decode(MakeCornerRoute(1)).timeout_ms, 50);
+    json::Dict own_budget = MakeCornerRoute(2);
+    own_budget["timeout_ms"s] = json::Node{5};
+    ASSERT_EQUAL(city.Decode(own_budget).timeout_ms, 5);
+    json::Dict no_budget{{"id"s, 3}, {"type"s, "Map"s}, {"timeout_ms"s, 0}};
+    ASSERT_EQUAL(city.Decode(no_budget).timeout_ms, 0);
+}
+
+void TestNoBudgetIsUnaffected() {
+    // A global budget too small for any Map of this city, lifted by the request's timeout_ms 0.
+    const City city(MakeGridInput(1));
+    const json::Dict map{{"id"s, 1}, {"type"s, "Map"s}, {"timeout_ms"s, 0}};
+    json::Dict pareto = MakeCornerRoute(2);
+    pareto["pareto"s] = json::Node{true};
+    pareto["timeout_ms"s] = json::Node{0};
+    json::Dict alternatives = MakeCornerRoute(3);
+    alternatives["alternatives"s] = json::Node{5};
+    alternatives["timeout_ms"s] = json::Node{0};
+
+    const json::Node map_response = city.reader.ExecuteStatRequest(city.Decode(map), city.handler);
+    ASSERT_EQUAL(GetErrorMessage(map_response), ""sv);
+    ASSERT(map_response.AsDict().at("map"sv).AsString().size() > 1000);
+    const json::Node pareto_response = city.reader.ExecuteStatRequest(city.Decode(pareto), city.handler);
+    ASSERT_EQUAL(GetErrorMessage(pareto_response), ""sv);
+    const json::Node alternatives_response = city.reader.ExecuteStatRequest(city.Decode(alternatives), city.handler);
+    ASSERT_EQUAL(GetErrorMessage(alternatives_response), ""sv);
+    ASSERT_EQUAL(alternatives_response.AsDict().at("routes"sv).AsArray().size(), 5u);
+}
+
+// Requests that differ only in their budget may get different answers, so both run.
+void TestTimeoutIsPartOfDeduplication() {
+    const City city(MakeGridInput());
+    json::Dict limited{{"id"s, 1}, {"type"s, "Map"s}, {"timeout_ms"s, 10}};
+    const json::Dict unlimited{{"id"s, 2}, {"type"s, "Map"s}};
+    const std::vector<StatRequest> requests{city.Decode(limited), city.Decode(unlimited), city.Decode(limited)};
+    const StatRequestPlan plan = PlanStatRequests(requests);
+    ASSERT_EQUAL(plan.execution_order.size(), 2u);
+    ASSERT_EQUAL(plan.answer_sources[0], 0u);
+    ASSERT_EQUAL(plan.answer_sources[1], 1u);
+    ASSERT_EQUAL(plan.answer_sources[2], 0u);
+}
+
+json::Dict MakeBusRequest(int id, const std::string& name) {
+    return {{"id"s, id}, {"type"s, "Bus"s}, {"name"s, name}};
+}
+
+json::Dict MakeStopRequest(int id, const std::string& name) {
+    return {{"id"s, id}, {"type"s, "Stop"s}, {"name"s, name}};
+}
+
+json::Node WithRequestId(const json::Node& response, int id) {
+    json::Dict response_map = response.AsDict();
+    response_map["request_id"s] = json::Node{id};
+    return json::Node{std::move(response_map)};
+}
+
+std::vector<StatRequest> DecodeAll(const City& city, const std::vector<json::Dict>& request_maps) {
+    std::vector<StatRequest> requests;
+    for (const json::Dict& request_map : request_maps) {
+        requests.push_back(city.Decode(request_map));
+    }
+    return requests;
+}
+
+void TestPlanDeduplicatesRequests() {
+    const City city(MakeGridInput());
+    json::Dict slow_map{{"id"s, 7}, {"type"s, "Map"s}, {"timeout_ms"s, 60000}};
+    const std::vector<StatRequest> requests = DecodeAll(city, {
+        MakeBusRequest(1, "R0"s),
+        MakeRoute(2, GetStopName(0, 0), GetStopName(5, 5)),
+        MakeStopRequest(3, GetStopName(1, 1)),
+        MakeBusRequest(4, "R0"s),
+        MakeRoute(5, GetStopName(2, 2), GetStopName(5, 5)),
+        MakeRoute(6, GetStopName(0, 0), GetStopName(3, 3)),
+        slow_map,
+        {{"id"s, 8}, {"type"s, "Map"s}},
+        MakeRoute(9, GetStopName(0, 0), GetStopName(5, 5)),
+        MakeBusRequest(10, "C0"s),
+    });
+    const StatRequestPlan plan = PlanStatRequests(requests);
+
+    // Requests 4 and 9 repeat 1 and 2 under another id; the two Maps differ in budget.
+    ASSERT_EQUAL(plan.execution_order.size(), 8u);
+    const std::vector<size_t> expected_sources{0, 1, 2, 0, 4, 5, 6, 7, 1, 9};
+    ASSERT(plan.answer_sources == expected_sources);
+    for (const size_t index : plan.execution_order) {
+        ASSERT_EQUAL(plan.answer_sources[index], index);
+    }
+    std::vector<size_t> executed = plan.execution_order;
+    std::sort(executed.begin(), executed.end());
+    ASSERT(std::adjacent_find(executed.begin(), executed.end()) == executed.end());
+
+    // Both Route requests from the corner are answered one after the other.
+    const auto first_corner_route = std::find(plan.execution_order.begin(), plan.execution_order.end(), 1u);
+    const auto second_corner_route = std::find(plan.execution_order.begin(), plan.execution_order.end(), 5u);
+    ASSERT(first_corner_route != plan.execution_order.end() && second_corner_route != plan.execution_order.end());
+    ASSERT_EQUAL(std::abs(second_corner_route - first_corner_route), 1);
+}
+
+void TestExecuteKeepsInputOrder() {
+    const City city(MakeGridInput());
+    json::Dict pareto = MakeCornerRoute(4);
+    pareto["pareto"s] = json::Node{true};
+    json::Dict slow_map{{"id"s, 6}, {"type"s, "Map"s}, {"timeout_ms"s, 60000}};
+    const std::vector<StatRequest> requests = DecodeAll(city, {
+        {{"id"s, 1}, {"type"s, "Map"s}},
+        MakeBusRequest(2, "R3"s),
+        MakeRoute(3, GetStopName(4, 4), GetStopName(0, 7)),
+        pareto,
+        MakeBusRequest(5, "R3"s),
+        slow_map,
+        MakeStopRequest(7, "Nowhere"s),
+        MakeRoute(8, GetStopName(4, 4), GetStopName(0, 7)),
+        MakeStopRequest(9, GetStopName(2, 9)),
+    });
+    const StatRequestPlan plan = PlanStatRequests(requests);
+    ASSERT(plan.execution_order.front() != 0u);
+
+    const json::Array responses = city.reader.ExecuteStatRequests(requests, plan, city.handler);
+    ASSERT_EQUAL(responses.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        ASSERT_EQUAL(responses[i].AsDict().at("request_id"sv).AsInt(), requests[i].id);
+        ASSERT_HINT(responses[i] == city.reader.ExecuteStatRequest(requests[i], city.handler),
+                    "response "s + std::to_string(i));
+    }
+    // Copied answers differ from their source in the id only.
+    ASSERT(responses[4] == WithRequestId(responses[1], 5));
+    ASSERT(responses[7] == WithRequestId(responses[2], 8));
+    ASSERT(responses[5] == WithRequestId(responses[0], 6));
+    ASSERT(responses[4] != responses[1]);
+}
+
+// Maps and alternatives are answered on their own thread while Bus and Stop requests
+// are answered on the calling one; the responses still come back in input order.
+void TestMixedRequestsKeepInputOrder() {
+    const City city(MakeGridInput());
+    std::vector<json::Dict> request_maps;
+    int id = 0;
+    for (int i = 0; i < GRID; ++i) {
+        request_maps.push_back({{"id"s, ++id}, {"type"s, "Map"s}, {"timeout_ms"s, 60000 + i}});
+        json::Dict alternatives = MakeRoute(++id, GetStopName(i, 0), GetStopName(GRID - 1 - i, GRID - 1));
+        alternatives["alternatives"s] = json::Node{3};
+        request_maps.push_back(std::move(alternatives));
+        for (int j = 0; j < GRID; ++j) {
+            request_maps.push_back(MakeBusRequest(++id, (j % 2 == 0 ? "R"s : "C"s) + std::to_string((i + j) % GRID)));
+            request_maps.push_back(MakeStopRequest(++id, GetStopName(j, i)));
+        }
+    }
+    const std::vector<StatRequest> requests = DecodeAll(city, request_maps);
+
+    const json::Array responses = city.reader.ExecuteStatRequests(requests, PlanStatRequests(requests), city.handler);
+    ASSERT_EQUAL(responses.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const json::Dict& response = responses[i].AsDict();
+        ASSERT_EQUAL(response.at("request_id"sv).AsInt(), static_cast<int>(i) + 1);
+        switch (requests[i].type) {
+            case StatRequestType::MAP:
+                ASSERT_EQUAL(response.count("map"sv), 1u);
+                break;
+            case StatRequestType::ROUTE:
+                ASSERT_EQUAL(response.at("routes"sv).AsArray().size(), 3u);
+                break;
+            case StatRequestType::BUS:
+                ASSERT_EQUAL(response.at("stop_count"sv).AsInt(), 2 * GRID - 1);
+                break;
+            default:
+                ASSERT_EQUAL(response.at("buses"sv).AsArray().size(), 2u);
+                break;
+        }
+        ASSERT_HINT(responses[i] == city.reader.ExecuteStatRequest(requests[i], city.handler),
+                    "response "s + std::to_string(i));
+    }
+}
+
+void TestRouteCacheSize() {
+    const City city(MakeGridInput());
+    json::Dict routing_settings{{"bus_wait_time"s, 2}, {"bus_velocity"s, 30.0}};
+    ASSERT_EQUAL(city.reader.ParseRoutingSettings(routing_settings).route_cache_capacity,
+                 transport_router::RoutingSettings{}.route_cache_capacity);
+    routing_settings["route_cache_size"s] = json::Node{0};
+    ASSERT_EQUAL(city.reader.ParseRoutingSettings(routing_settings).route_cache_capacity, 0u);
+    routing_settings["route_cache_size"s] = json::Node{128};
+    ASSERT_EQUAL(city.reader.ParseRoutingSettings(routing_settings).route_cache_capacity, 128u);
+    routing_settings["route_cache_size"s] = json::Node{-1};
+    ASSERT_THROWS(city.reader.ParseRoutingSettings(routing_settings), std::invalid_argument);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestDeadline);
+    RUN_TEST(runner, TestExpiredBudgetAnswersTimeout);
+    RUN_TEST(runner, TestDefaultAndPerRequestTimeout);
+    RUN_TEST(runner, TestNoBudgetIsUnaffected);
+    RUN_TEST(runner, TestTimeoutIsPartOfDeduplication);
+    RUN_TEST(runner, TestPlanDeduplicatesRequests);
+    RUN_TEST(runner, TestExecuteKeepsInputOrder);
+    RUN_TEST(runner, TestMixedRequestsKeepInputOrder);
+    RUN_TEST(runner, TestRouteCacheSize);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include "json.h"
+#include "json_builder.h"
+#include "test_framework.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::literals;
+
+namespace {
+
+json::Node LoadFromString(const std::string& text) {
+    std::istringstream input(text);
+    return json::Load(input).GetRoot();
+}
+
+std::string PrintToString(const json::Node& node) {
+    std::ostringstream output;
+    json::Print(json::Document{node}, output);
+    return output.str();
+}
+
+void TestLoadScalars() {
+    ASSERT(LoadFromString("null"s).IsNull());
+    ASSERT_EQUAL(LoadFromString("true"s).AsBool(), true);
+    ASSERT_EQUAL(LoadFromString(" false "s).AsBool(), false);
+    ASSERT_EQUAL(LoadFromString("42"s).AsInt(), 42);
+    ASSERT_EQUAL(LoadFromString("-7"s).AsInt(), -7);
+    ASSERT(LoadFromString("1.5e2"s).IsPureDouble());
+    ASSERT_EQUAL(LoadFromString("1.5e2"s).AsDouble(), 150.0);
+    ASSERT_EQUAL(LoadFromString("\"a\\n\\\"b\\\"\""s).AsString(), "a\n\"b\""sv);
+    ASSERT_THROWS(LoadFromString("\"unterminated"s), json::ParsingError);
+    ASSERT_THROWS(LoadFromString("nul"s), json::ParsingError);
+    ASSERT_THROWS(LoadFromString("[1, 2"s), json::ParsingError);
+}
+
+void TestDict() {
+    json::Dict dict{{"b"s, 2}, {"a"s, 1}, {"b"s, 3}};
+    ASSERT_EQUAL(dict.size(), 2u);
+    ASSERT_EQUAL(dict.begin()->first, "a"s);
+    ASSERT_EQUAL(dict.at("b"sv).AsInt(), 2);
+    ASSERT_EQUAL(dict.count("c"sv), 0u);
+    ASSERT_THROWS(dict.at("c"sv), std::out_of_range);
+    dict["c"s] = json::Node{"x"s};
+    ASSERT_EQUAL(dict.at("c"sv).AsString(), "x"sv);
+    ASSERT(!dict.emplace("a"s, 5).second);
+    ASSERT_EQUAL(dict.at("a"sv).AsInt(), 1);
+}
+
+void TestRoundTrip() {
+    const json::Node node = json::Builder{}
+                                .StartDict()
+                                .Key("array"s).StartArray().Value(1).Value(2.5).Value("s\t"s).EndArray()
+                                .Key("dict"s).StartDict().Key("null"s).Value(nullptr).EndDict()
+                                .Key("flag"s).Value(true)
+                                .EndDict()
+                                .Build();
+    const std::string text = PrintToString(node);
+    ASSERT(LoadFromString(text) == node);
+    ASSERT_EQUAL(PrintToString(LoadFromString(text)), text);
+}
+
+void TestLoadViewMatchesLoad() {
+    const std::string text = R"({"base_requests": [{"name": "A", "id": 1}, {"name": "B\"", "id": 2}],)"
+                             R"( "stat_requests": [{"type": "Stop", "name": "A"}]})"s;
+    std::istringstream input(text);
+    const json::Document expected = json::Load(input);
+    ASSERT(json::LoadView(text) == expected);
+    ASSERT(json::LoadViewParallel(text, 4) == expected);
+    const json::Document view = json::LoadView(text);
+    const std::string_view name = view.GetRoot().AsDict().at("base_requests"sv).AsArray()[0].AsDict().at("name"sv).AsString();
+    ASSERT(name.data() >= text.data() && name.data() < text.data() + text.size());
+}
+
+// Arrays of more than 2 MiB are split between threads after a scan for element starts.
+void TestLoadViewParallelLargeArrays() {
+    std::string elements;
+    for (int i = 0; elements.size() < (5u << 20) / 2; ++i) {
+        elements += R"({"type": "Stop", "name": "Stop )"s + std::to_string(i) + R"(", "latitude": 55.5},)"s + "\n"s;
+    }
+    elements.pop_back();
+    elements.pop_back();
+    const std::string text = R"({"base_requests": [)"s + elements + "]}"s;
+    std::istringstream input(text);
+    ASSERT(json::LoadViewParallel(text, 4) == json::Load(input));
+
+    // A dropped comma or stray characters between elements are errors, not a lost element.
+    const size_t middle = text.find("},"s, text.size() / 2);
+    std::string missing_comma = text;
+    missing_comma[middle + 1] = ' ';
+    ASSERT_THROWS(json::LoadViewParallel(missing_comma, 4), json::ParsingError);
+    std::string stray = text;
+    stray.insert(middle + 1, " 7"s);
+    ASSERT_THROWS(json::LoadViewParallel(stray, 4), json::ParsingError);
+    std::string two_commas = text;
+    two_commas.insert(middle + 1, ","s);
+    ASSERT_THROWS(json::LoadViewParallel(two_commas, 4), json::ParsingError);
+}
+
+void TestObjectReader() {
+    std::istringstream input(R"({"first": {"x": 1}, "items": [1, "two", [3]], "last": null})"s);
+    json::ObjectReader reader(input);
+
+    ASSERT(reader.NextKey() == std::optional{"first"s});
+    ASSERT_EQUAL(reader.ReadValue().AsDict().at("x"sv).AsInt(), 1);
+
+    ASSERT(reader.NextKey() == std::optional{"items"s});
+    ASSERT(reader.StartArray());
+    ASSERT_EQUAL(reader.NextElement()->AsInt(), 1);
+    ASSERT_EQUAL(reader.NextElement()->AsString(), "two"sv);
+    ASSERT_EQUAL(reader.NextElement()->AsArray().size(), 1u);
+    ASSERT(!reader.NextElement());
+
+    ASSERT(reader.NextKey() == std::optional{"last"s});
+    ASSERT(!reader.StartArray());
+    ASSERT(reader.ReadValue().IsNull());
+    ASSERT(!reader.NextKey());
+}
+
+void TestArrayWriterMatchesPrint() {
+    const json::Array items{json::Node{1}, json::Node{json::Dict{{"k"s, "v"s}}}, json::Node{json::Array{}}};
+    std::ostringstream output;
+    json::ArrayWriter writer(output);
+    for (const json::Node& item : items) {
+        writer.Write(item);
+    }
+    writer.Finish();
+    ASSERT_EQUAL(output.str(), PrintToString(json::Node{items}));
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestLoadScalars);
+    RUN_TEST(runner, TestDict);
+    RUN_TEST(runner, TestRoundTrip);
+    RUN_TEST(runner, TestLoadViewMatchesLoad);
+    RUN_TEST(runner, TestLoadViewParallelLargeArrays);
+    RUN_TEST(runner, TestObjectReader);
+    RUN_TEST(runner, TestArrayWriterMatchesPrint);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
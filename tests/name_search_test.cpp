@@ -0,0 +1,191 @@
+#include "name_search.h"
+#include "test_framework.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// A small alphabet, so that names share prefixes and queries land within a few edits.
+// The two-byte letters are compared byte by byte, as the index does.
+const std::vector<std::string> PIECES{"a"s, "b"s, "c"s, " "s, "é"s, "ж"s};
+
+std::string MakeString(std::mt19937& generator, int max_pieces) {
+    std::uniform_int_distribution<int> count(0, max_pieces);
+    std::uniform_int_distribution<size_t> piece(0, PIECES.size() - 1);
+    std::string result;
+    for (int i = count(generator); i > 0; --i) {
+        result += PIECES[piece(generator)];
+    }
+    return result;
+}
+
+// The least Levenshtein distance between query and any prefix of name.
+int GetPrefixEditDistance(std::string_view query, std::string_view name) {
+    std::vector<int> row(query.size() + 1);
+    for (size_t j = 0; j < row.size(); ++j) {
+        row[j] = static_cast<int>(j);
+    }
+    int best = row.back();
+    for (size_t i = 1; i <= name.size(); ++i) {
+        int diagonal = row[0];
+        row[0] = static_cast<int>(i);
+        for (size_t j = 1; j < row.size(); ++j) {
+            const int above = row[j];
+            row[j] = std::min({above + 1, row[j - 1] + 1, diagonal + (query[j - 1] != name[i - 1] ? 1 : 0)});
+            diagonal = above;
+        }
+        best = std::min(best, row.back());
+    }
+    return best;
+}
+
+std::vector<name_search::Match> SearchSlowly(const std::vector<std::string>& names, std::string_view query,
+                                             int max_edits, size_t max_count) {
+    std::vector<std::string_view> unique_names(names.begin(), names.end());
+    std::sort(unique_names.begin(), unique_names.end());
+    unique_names.erase(std::unique(unique_names.begin(), unique_names.end()), unique_names.end());
+    std::vector<std::pair<int, std::string_view>> found;
+    for (const std::string_view name : unique_names) {
+        const int edits = GetPrefixEditDistance(query, name);
+        if (edits <= max_edits) {
+            found.emplace_back(edits, name);
+        }
+    }
+    // std::string_view compares bytes as unsigned, as the index orders names.
+    std::sort(found.begin(), found.end());
+    std::vector<name_search::Match> matches;
+    for (size_t i = 0; i < found.size() && i < max_count; ++i) {
+        matches.push_back({found[i].second, found[i].first});
+    }
+    return matches;
+}
+
+name_search::NameSearchIndex MakeIndex(const std::vector<std::string>& names) {
+    return name_search::NameSearchIndex({names.begin(), names.end()});
+}
+
+void CheckSearch(const name_search::NameSearchIndex& index, const std::vector<std::string>& names,
+                 std::string_view query, int max_edits, size_t max_count) {
+    const std::vector<name_search::Match> expected = SearchSlowly(names, query, max_edits, max_count);
+    const std::vector<name_search::Match> actual = index.Search(query, max_edits, max_count);
+    const std::string hint = "query \""s + std::string{query} + "\", max_edits "s + std::to_string(max_edits)
+                             + ", max_count "s + std::to_string(max_count);
+    ASSERT_EQUAL_HINT(actual.size(), expected.size(), hint);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQUAL_HINT(actual[i].name, expected[i].name, hint);
+        ASSERT_EQUAL_HINT(actual[i].edits, expected[i].edits, hint);
+    }
+}
+
+void TestPrefixEditDistance() {
+    ASSERT_EQUAL(GetPrefixEditDistance(""sv, "abc"sv), 0);
+    ASSERT_EQUAL(GetPrefixEditDistance("abc"sv, ""sv), 3);
+    ASSERT_EQUAL(GetPrefixEditDistance("ab"sv, "abc"sv), 0);
+    ASSERT_EQUAL(GetPrefixEditDistance("ac"sv, "abc"sv), 1);
+    ASSERT_EQUAL(GetPrefixEditDistance("abd"sv, "abc"sv), 1);
+    ASSERT_EQUAL(GetPrefixEditDistance("xabc"sv, "abc"sv), 1);
+    ASSERT_EQUAL(GetPrefixEditDistance("kitten"sv, "sitting"sv), 2);
+}
+
+void TestMatchesBruteForce() {
+    std::mt19937 generator(50);
+    for (int round = 0; round < 40; ++round) {
+        std::vector<std::string> names;
+        std::uniform_int_distribution<int> name_count(1, 60);
+        for (int i = name_count(generator); i > 0; --i) {
+            names.push_back(MakeString(generator, 6));
+        }
+        const name_search::NameSearchIndex index = MakeIndex(names);
+        for (int query_index = 0; query_index < 25; ++query_index) {
+            std::string query = MakeString(generator, 5);
+            if (query_index % 3 == 0) {
+                // A prefix of a present name, with a letter replaced.
+                const std::string& name = names[generator() % names.size()];
+                query = name.substr(0, generator() % (name.size() + 1));
+                if (!query.empty()) {
+                    query[generator() % query.size()] = 'b';
+                }
+            }
+            for (int max_edits = 0; max_edits <= name_search::NameSearchIndex::MAX_EDITS; ++max_edits) {
+                for (const size_t max_count : {size_t{0}, size_t{1}, size_t{3}, names.size() + 1}) {
+                    CheckSearch(index, names, query, max_edits, max_count);
+                }
+            }
+        }
+    }
+}
+
+void TestEmptyQueryAndEmptyName() {
+    const std::vector<std::string> names{"b"s, ""s, "ab"s, "a"s, "ab"s};
+    const name_search::NameSearchIndex index = MakeIndex(names);
+    ASSERT_EQUAL(index.GetSize(), 4u);
+    for (int max_edits = 0; max_edits <= name_search::NameSearchIndex::MAX_EDITS; ++max_edits) {
+        // Every name starts with the empty query, the empty name first.
+        const std::vector<name_search::Match> matches = index.Search(""sv, max_edits, 10);
+        ASSERT_EQUAL(matches.size(), 4u);
+        ASSERT_EQUAL(matches.front().name, ""sv);
+        ASSERT_EQUAL(matches.back().name, "b"sv);
+        for (int edits = 0; edits < 4; ++edits) {
+            CheckSearch(index, names, "x"s + std::string(edits, 'a'), max_edits, 10);
+        }
+    }
+    // The empty name is one deletion away from any single letter.
+    const std::vector<name_search::Match> matches = index.Search("z"sv, 1, 10);
+    ASSERT_EQUAL(matches.size(), 4u);
+    ASSERT_EQUAL(matches.front().name, ""sv);
+    ASSERT_EQUAL(matches.front().edits, 1);
+}
+
+void TestUtf8Names() {
+    const std::vector<std::string> names{"Улица Лизы Чайкиной"s, "Улица Докучаева"s, "Café Central"s, "Cafe Nord"s};
+    const name_search::NameSearchIndex index = MakeIndex(names);
+    const std::vector<name_search::Match> prefix = index.Search("Улица"sv, 0, 10);
+    ASSERT_EQUAL(prefix.size(), 2u);
+    ASSERT_EQUAL(prefix[0].name, "Улица Докучаева"sv);
+    ASSERT_EQUAL(prefix[1].name, "Улица Лизы Чайкиной"sv);
+    // é is two bytes: e becomes the first, and the second starts the rest of the name.
+    const std::vector<name_search::Match> cafe = index.Search("Cafe"sv, 1, 10);
+    ASSERT_EQUAL(cafe.size(), 2u);
+    ASSERT_EQUAL(cafe[0].name, "Cafe Nord"sv);
+    ASSERT_EQUAL(cafe[0].edits, 0);
+    ASSERT_EQUAL(cafe[1].name, "Café Central"sv);
+    ASSERT_EQUAL(cafe[1].edits, 1);
+    for (const std::string_view query : {"Улица Лизы"sv, "Улица Лиза"sv, "Cafè"sv, "Улица Д"sv, "Ул"sv}) {
+        for (int max_edits = 0; max_edits <= name_search::NameSearchIndex::MAX_EDITS; ++max_edits) {
+            CheckSearch(index, names, query, max_edits, 10);
+        }
+    }
+}
+
+void TestEmptyIndexAndLimits() {
+    const name_search::NameSearchIndex default_index;
+    ASSERT_EQUAL(default_index.GetSize(), 0u);
+    ASSERT(default_index.Search(""sv, 0, 10).empty());
+    ASSERT(default_index.Search("a"sv, 3, 10).empty());
+
+    const name_search::NameSearchIndex empty_index(std::vector<std::string_view>{});
+    ASSERT(empty_index.Search(""sv, 2, 10).empty());
+
+    const name_search::NameSearchIndex index({"a"sv});
+    ASSERT_THROWS(index.Search("a"sv, -1, 10), std::invalid_argument);
+    ASSERT_THROWS(index.Search("a"sv, name_search::NameSearchIndex::MAX_EDITS + 1, 10), std::invalid_argument);
+    ASSERT_THROWS(default_index.Search("a"sv, -1, 10), std::invalid_argument);
+    ASSERT(index.Search("a"sv, 0, 0).empty());
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestPrefixEditDistance);
+    RUN_TEST(runner, TestMatchesBruteForce);
+    RUN_TEST(runner, TestEmptyQueryAndEmptyName);
+    RUN_TEST(runner, TestUtf8Names);
+    RUN_TEST(runner, TestEmptyIndexAndLimits);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include "perfect_hash.h"
+#include "test_framework.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+std::vector<std::string> MakeNames(size_t count, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> length(0, 24);
+    std::uniform_int_distribution<int> byte(1, 255);
+    std::vector<std::string> names;
+    // Similar names, as stop names are, and random bytes of every length.
+    for (size_t i = 0; names.size() < count; ++i) {
+        names.push_back("Stop "s + std::to_string(i));
+        if (names.size() < count) {
+            std::string name(length(generator), ' ');
+            for (char& c : name) {
+                c = static_cast<char>(byte(generator));
+            }
+            names.push_back(std::move(name));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+std::vector<std::string_view> ToViews(const std::vector<std::string>& names) {
+    return {names.begin(), names.end()};
+}
+
+perfect_hash::NameIndex<int> MakeIndex(const std::vector<std::string>& names) {
+    std::vector<std::pair<std::string_view, int>> entries;
+    for (size_t i = 0; i < names.size(); ++i) {
+        entries.emplace_back(names[i], static_cast<int>(i) + 1);
+    }
+    return perfect_hash::NameIndex<int>(entries);
+}
+
+void TestLayoutIsCollisionFree() {
+    for (const size_t count : {1, 2, 3, 4, 7, 31, 100, 1000, 20000}) {
+        const std::vector<std::string> names = MakeNames(count, static_cast<unsigned>(count));
+        const perfect_hash::detail::Layout layout = perfect_hash::detail::BuildLayout(ToViews(names));
+        ASSERT_EQUAL(layout.name_slots.size(), names.size());
+        // Minimal and collision free: the slots are a permutation of [0, n).
+        std::vector<uint32_t> slots = layout.name_slots;
+        std::sort(slots.begin(), slots.end());
+        for (size_t i = 0; i < slots.size(); ++i) {
+            ASSERT_EQUAL_HINT(slots[i], i, std::to_string(count) + " names"s);
+        }
+        // Lookups land on the slot the name was placed in.
+        for (size_t i = 0; i < names.size(); ++i) {
+            const uint64_t hash = perfect_hash::detail::Hash(names[i], layout.seed);
+            const uint32_t displacement = layout.displacements[perfect_hash::detail::GetBucket(hash, layout.displacements.size())];
+            ASSERT_EQUAL(perfect_hash::detail::GetSlot(hash, displacement, names.size()), layout.name_slots[i]);
+        }
+    }
+}
+
+void TestFindsEveryName() {
+    const std::vector<std::string> names = MakeNames(5000, 1);
+    const perfect_hash::NameIndex<int> index = MakeIndex(names);
+    ASSERT_EQUAL(index.GetSize(), names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        ASSERT_EQUAL(index.Find(names[i]), static_cast<int>(i) + 1);
+    }
+}
+
+void TestAbsentNames() {
+    const std::vector<std::string> names = MakeNames(5000, 2);
+    const perfect_hash::NameIndex<int> index = MakeIndex(names);
+    for (const std::string& name : MakeNames(5000, 3)) {
+        if (!std::binary_search(names.begin(), names.end(), name)) {
+            ASSERT_EQUAL(index.Find(name), 0);
+        }
+    }
+    // Prefixes, extensions and near misses of present names.
+    for (const std::string& name : names) {
+        if (!name.empty() && !std::binary_search(names.begin(), names.end(), name.substr(0, name.size() - 1))) {
+            ASSERT_EQUAL(index.Find(std::string_view{name}.substr(0, name.size() - 1)), 0);
+        }
+        if (!std::binary_search(names.begin(), names.end(), name + "x"s)) {
+            ASSERT_EQUAL(index.Find(name + "x"s), 0);
+        }
+    }
+}
+
+void TestEmptyAndSingleKeySets() {
+    const perfect_hash::NameIndex<int> default_index;
+    ASSERT_EQUAL(default_index.GetSize(), 0u);
+    ASSERT_EQUAL(default_index.Find(""sv), 0);
+    ASSERT_EQUAL(default_index.Find("Stop"sv), 0);
+
+    const perfect_hash::NameIndex<int> empty_index(std::vector<std::pair<std::string_view, int>>{});
+    ASSERT_EQUAL(empty_index.GetSize(), 0u);
+    ASSERT_EQUAL(empty_index.Find("Stop"sv), 0);
+
+    const perfect_hash::NameIndex<int> single_index({{"Stop"sv, 7}});
+    ASSERT_EQUAL(single_index.GetSize(), 1u);
+    ASSERT_EQUAL(single_index.Find("Stop"sv), 7);
+    ASSERT_EQUAL(single_index.Find("Stops"sv), 0);
+    ASSERT_EQUAL(single_index.Find(""sv), 0);
+
+    const perfect_hash::NameIndex<int> empty_name_index({{""sv, 3}});
+    ASSERT_EQUAL(empty_name_index.Find(""sv), 3);
+    ASSERT_EQUAL(empty_name_index.Find("a"sv), 0);
+}
+
+void TestPointerValuesAndUtf8() {
+    const std::vector<std::string> names{"Улица Лизы Чайкиной"s, "Улица Лизы Чайкиной 2"s, "Café"s, "Cafe"s};
+    std::vector<std::pair<std::string_view, const std::string*>> entries;
+    for (const std::string& name : names) {
+        entries.emplace_back(name, &name);
+    }
+    const perfect_hash::NameIndex<const std::string*> index(entries);
+    for (const std::string& name : names) {
+        ASSERT(index.Find(name) == &name);
+    }
+    ASSERT(index.Find("Улица Лизы"sv) == nullptr);
+    ASSERT(index.Find("Caf"sv) == nullptr);
+}
+
+void TestDuplicateNamesThrow() {
+    using Entries = std::vector<std::pair<std::string_view, int>>;
+    ASSERT_THROWS(perfect_hash::NameIndex<int>(Entries{{"a"sv, 1}, {"b"sv, 2}, {"a"sv, 3}}), std::invalid_argument);
+    ASSERT_THROWS(perfect_hash::NameIndex<int>(Entries{{""sv, 1}, {""sv, 2}}), std::invalid_argument);
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestLayoutIsCollisionFree);
+    RUN_TEST(runner, TestFindsEveryName);
+    RUN_TEST(runner, TestAbsentNames);
+    RUN_TEST(runner, TestEmptyAndSingleKeySets);
+    RUN_TEST(runner, TestPointerValuesAndUtf8);
+    RUN_TEST(runner, TestDuplicateNamesThrow);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,473 @@
+#include "test_framework.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+double GetTotalTime(const transport_router::Route& route) {
+    double total = 0.0;
+    for (const auto* edge : route) {
+        total += edge->weight;
+    }
+    return total;
+}
+
+bool IsClose(double lhs, double rhs) {
+    return std::abs(lhs - rhs) < 1e-9;
+}
+
+size_t CountWaits(const transport_router::Route& route) {
+    return std::count_if(route.begin(), route.end(), [](const auto* edge) {
+        return edge->quality == 0;
+    });
+}
+
+// Times are compared in microseconds, so that sums taken in different orders agree.
+long long ToMicroseconds(double minutes) {
+    return std::llround(minutes * 1e6);
+}
+
+// Consecutive edges meet, no vertex repeats, and the route starts with a wait at from.
+void CheckRouteShape(const transport_router::Route& route, std::string_view from) {
+    ASSERT(!route.empty());
+    ASSERT_EQUAL(route.front()->quality, 0u);
+    ASSERT_EQUAL(route.front()->name, from);
+    ASSERT(route.back()->quality > 0);
+    std::set<graph::VertexId> vertices{route.front()->from};
+    for (size_t i = 0; i < route.size(); ++i) {
+        if (i > 0) {
+            ASSERT_EQUAL(route[i - 1]->to, route[i]->from);
+        }
+        ASSERT_HINT(vertices.insert(route[i]->to).second, "the route visits a vertex twice");
+    }
+}
+
+// Waiting takes 6 minutes and buses cover 1000 m in 1.5 minutes.
+transport_router::RoutingSettings MakeSettings() {
+    transport_router::RoutingSettings settings;
+    settings.bus_wait_time = 6;
+    settings.bus_velocity = 40.0;
+    return settings;
+}
+
+constexpr double MINUTES_PER_METER = 1.5 / 1000;
+
+// Linear bus 1: A - B - C, roundtrip bus 2: C - D - C, and an unreachable stop E.
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue) {
+    catalogue.AddStop("A"sv, {55.0, 37.0});
+    catalogue.AddStop("B"sv, {55.01, 37.0});
+    catalogue.AddStop("C"sv, {55.02, 37.0});
+    catalogue.AddStop("D"sv, {55.03, 37.0});
+    catalogue.AddStop("E"sv, {56.0, 37.0});
+    catalogue.SetDistance("A"sv, "B"sv, 1000);
+    catalogue.SetDistance("B"sv, "C"sv, 2000);
+    catalogue.SetDistance("C"sv, "B"sv, 3000);
+    catalogue.SetDistance("C"sv, "D"sv, 500);
+    catalogue.SetDistance("D"sv, "C"sv, 700);
+    catalogue.AddBus("1"sv, {"A"sv, "B"sv, "C"sv}, false);
+    catalogue.AddBus("2"sv, {"C"sv, "D"sv, "C"sv}, true);
+    catalogue.Finalize();
+}
+
+void TestRouteOnOneBus() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+    ASSERT(!router.IsBuilt());
+
+    const auto there = router.GetRoute("A"sv, "C"sv);
+    ASSERT(router.IsBuilt());
+    ASSERT(there);
+    ASSERT_EQUAL(there->size(), 2u);
+    ASSERT_EQUAL(there->front()->name, "A"sv);
+    ASSERT_EQUAL(there->back()->name, "1"sv);
+    ASSERT_EQUAL(there->back()->quality, 2u);
+    ASSERT(IsClose(GetTotalTime(*there), 6 + 3000 * MINUTES_PER_METER));
+
+    // The way back uses the road lengths of the other direction.
+    const auto back = router.GetRoute("C"sv, "A"sv);
+    ASSERT(back);
+    ASSERT(IsClose(GetTotalTime(*back), 6 + 4000 * MINUTES_PER_METER));
+}
+
+void TestRouteWithTransfer() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+
+    const auto route = router.GetRoute("B"sv, "D"sv);
+    ASSERT(route);
+    ASSERT_EQUAL(route->size(), 4u);
+    ASSERT(IsClose(GetTotalTime(*route), 6 + 2000 * MINUTES_PER_METER + 6 + 500 * MINUTES_PER_METER));
+}
+
+void TestTrivialAndMissingRoutes() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+
+    const auto same_stop = router.GetRoute("B"sv, "B"sv);
+    ASSERT(same_stop);
+    ASSERT(same_stop->empty());
+    ASSERT(!router.GetRoute("A"sv, "E"sv));
+    ASSERT_THROWS(router.GetRoute("A"sv, "Nowhere"sv), std::out_of_range);
+}
+
+void TestRouteCache() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+
+    const auto first = router.GetRoute("A"sv, "D"sv);
+    const auto second = router.GetRoute("A"sv, "D"sv);
+    ASSERT(first && second);
+    ASSERT(*first == *second);
+    ASSERT(!router.GetRoute("E"sv, "A"sv));
+    ASSERT(!router.GetRoute("E"sv, "A"sv));
+    const cache::CacheStats stats = router.GetRouteCacheStats();
+    ASSERT_EQUAL(stats.hits, 2u);
+    ASSERT_EQUAL(stats.misses, 2u);
+}
+
+// A repeated name replaces the earlier stop, whose id stays taken, so the ids of the
+// later copies run past the number of distinct names.
+void TestRepeatedStopNames() {
+    transport_catalogue::TransportCatalogue catalogue;
+    catalogue.AddStop("A"sv, {55.0, 37.0});
+    catalogue.AddStop("B"sv, {50.0, 30.0});
+    catalogue.AddStop("C"sv, {50.0, 30.0});
+    catalogue.AddStop("B"sv, {55.01, 37.0});
+    catalogue.AddStop("C"sv, {55.02, 37.0});
+    catalogue.SetDistance("A"sv, "B"sv, 1000);
+    catalogue.SetDistance("B"sv, "C"sv, 2000);
+    catalogue.AddBus("1"sv, {"A"sv, "B"sv, "C"sv}, false);
+    catalogue.Finalize();
+    ASSERT_EQUAL(catalogue.GetAllStops().size(), 3u);
+    ASSERT_EQUAL(catalogue.GetStopCount(), 5u);
+    ASSERT_EQUAL(catalogue.FindStop("C"sv)->id, 4u);
+
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+    const auto route = router.GetRoute("A"sv, "C"sv);
+    ASSERT(route);
+    ASSERT(IsClose(GetTotalTime(*route), 6 + 3000 * MINUTES_PER_METER));
+    const auto back = router.GetRoute(catalogue.FindStop("C"sv), catalogue.FindStop("B"sv));
+    ASSERT(back);
+    ASSERT(IsClose(GetTotalTime(*back), 6 + 2000 * MINUTES_PER_METER));
+    ASSERT_EQUAL(router.GetParetoRoutes("C"sv, "A"sv).size(), 1u);
+    const auto alternatives = router.GetAlternativeRoutes("B"sv, "C"sv, 3);
+    ASSERT(!alternatives.empty());
+    ASSERT(IsClose(GetTotalTime(alternatives.front()), 6 + 2000 * MINUTES_PER_METER));
+}
+
+// Three ways from A to D: one slow bus, two buses, or three short rides.
+// Waiting takes 5 minutes and buses cover 1000 m per minute.
+void FillTradeOffCatalogue(transport_catalogue::TransportCatalogue& catalogue) {
+    for (const std::string_view name : {"A"sv, "B"sv, "C"sv, "D"sv, "E"sv}) {
+        catalogue.AddStop(name, {55.0, 37.0});
+    }
+    catalogue.SetDistance("A"sv, "D"sv, 30000);
+    catalogue.SetDistance("A"sv, "B"sv, 5000);
+    catalogue.SetDistance("B"sv, "D"sv, 5000);
+    catalogue.SetDistance("A"sv, "C"sv, 1000);
+    catalogue.SetDistance("C"sv, "E"sv, 1000);
+    catalogue.SetDistance("E"sv, "D"sv, 1000);
+    catalogue.AddBus("express"sv, {"A"sv, "D"sv}, false);
+    catalogue.AddBus("first"sv, {"A"sv, "B"sv}, false);
+    catalogue.AddBus("second"sv, {"B"sv, "D"sv}, false);
+    catalogue.AddBus("p"sv, {"A"sv, "C"sv}, false);
+    catalogue.AddBus("q"sv, {"C"sv, "E"sv}, false);
+    catalogue.AddBus("r"sv, {"E"sv, "D"sv}, false);
+    catalogue.Finalize();
+}
+
+transport_router::RoutingSettings MakeTradeOffSettings() {
+    transport_router::RoutingSettings settings;
+    settings.bus_wait_time = 5;
+    settings.bus_velocity = 60.0;
+    return settings;
+}
+
+void TestParetoFrontOfTradeOffs() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillTradeOffCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeTradeOffSettings(), catalogue);
+
+    const auto front = router.GetParetoRoutes("A"sv, "D"sv);
+    ASSERT_EQUAL(front.size(), 3u);
+    const std::vector<std::pair<long long, size_t>> expected{
+        {ToMicroseconds(18.0), 3}, {ToMicroseconds(20.0), 2}, {ToMicroseconds(35.0), 1}};
+    for (size_t i = 0; i < front.size(); ++i) {
+        CheckRouteShape(front[i], "A"sv);
+        ASSERT_EQUAL(ToMicroseconds(GetTotalTime(front[i])), expected[i].first);
+        ASSERT_EQUAL(CountWaits(front[i]), expected[i].second);
+    }
+    // The fastest route of the front is the shortest path.
+    ASSERT(IsClose(GetTotalTime(front.front()), GetTotalTime(*router.GetRoute("A"sv, "D"sv))));
+
+    const auto same_stop = router.GetParetoRoutes("A"sv, "A"sv);
+    ASSERT_EQUAL(same_stop.size(), 1u);
+    ASSERT(same_stop.front().empty());
+}
+
+void TestAlternativesOfTradeOffs() {
+    transport_catalogue::TransportCatalogue catalogue;
+    FillTradeOffCatalogue(catalogue);
+    const transport_router::TransportRouter router(MakeTradeOffSettings(), catalogue);
+
+    const auto routes = router.GetAlternativeRoutes("A"sv, "D"sv, 2);
+    ASSERT_EQUAL(routes.size(), 2u);
+    ASSERT_EQUAL(ToMicroseconds(GetTotalTime(routes[0])), ToMicroseconds(18.0));
+    ASSERT_EQUAL(ToMicroseconds(GetTotalTime(routes[1])), ToMicroseconds(20.0));
+    ASSERT(router.GetAlternativeRoutes("A"sv, "D"sv, 0).empty());
+}
+
+void TestAlternativesBeyondAvailablePaths() {
+    transport_catalogue::TransportCatalogue catalogue;
+    catalogue.AddStop("A"sv, {55.0, 37.0});
+    catalogue.AddStop("B"sv, {55.01, 37.0});
+    catalogue.AddStop("C"sv, {55.02, 37.0});
+    catalogue.AddStop("D"sv, {56.0, 37.0});
+    catalogue.SetDistance("A"sv, "B"sv, 1000);
+    catalogue.SetDistance("A"sv, "C"sv, 1000);
+    catalogue.SetDistance("C"sv, "B"sv, 1000);
+    catalogue.AddBus("direct"sv, {"A"sv, "B"sv}, false);
+    catalogue.AddBus("detour"sv, {"A"sv, "C"sv, "B"sv}, false);
+    catalogue.Finalize();
+    const transport_router::TransportRouter router(MakeSettings(), catalogue);
+
+    // The only loopless ways from A to B: direct, detour all the way, detour with a change at C.
+    const auto routes = router.GetAlternativeRoutes("A"sv, "B"sv, 100);
+    ASSERT_EQUAL(routes.size(), 3u);
+    ASSERT_EQUAL(routes[0].back()->name, "direct"sv);
+    ASSERT(IsClose(GetTotalTime(routes[0]), 6 + 1000 * MINUTES_PER_METER));
+    ASSERT_EQUAL(routes[1].size(), 2u);
+    ASSERT(IsClose(GetTotalTime(routes[1]), 6 + 2000 * MINUTES_PER_METER));
+    ASSERT_EQUAL(routes[2].size(), 4u);
+    ASSERT(IsClose(GetTotalTime(routes[2]), 12 + 2000 * MINUTES_PER_METER));
+    ASSERT(router.GetAlternativeRoutes("A"sv, "D"sv, 100).empty());
+}
+
+// Random networks checked against every loopless itinerary. An itinerary is a chain of
+// rides, each a wait and a trip on one bus between two of its stops, that visits no stop
+// twice; these are exactly the loopless paths of the routing graph.
+class RandomNetwork {
+public:
+    static constexpr size_t STOP_COUNT = 6;
+
+    explicit RandomNetwork(unsigned seed) {
+        std::mt19937 generator(seed);
+        const auto random = [&generator](int from, int to) {
+            return std::uniform_int_distribution<int>(from, to)(generator);
+        };
+        for (size_t i = 0; i < STOP_COUNT; ++i) {
+            stop_names_.push_back("S"s + std::to_string(i));
+            catalogue_.AddStop(stop_names_.back(), {55.0 + 0.01 * i, 37.0});
+        }
+        const int bus_count = random(3, 5);
+        for (int bus = 0; bus < bus_count; ++bus) {
+            std::vector<size_t> stops(STOP_COUNT);
+            for (size_t i = 0; i < STOP_COUNT; ++i) {
+                stops[i] = i;
+            }
+            std::shuffle(stops.begin(), stops.end(), generator);
+            stops.resize(random(2, 4));
+            const bool is_roundtrip = random(0, 1) == 1;
+            if (is_roundtrip) {
+                stops.push_back(stops.front());
+            }
+            std::vector<std::string_view> names;
+            for (size_t i = 0; i < stops.size(); ++i) {
+                names.push_back(stop_names_[stops[i]]);
+                if (i > 0) {
+                    catalogue_.SetDistance(names[i - 1], names[i], random(100, 3000));
+                    if (random(0, 2) == 0) {
+                        catalogue_.SetDistance(names[i], names[i - 1], random(100, 3000));
+                    }
+                }
+            }
+            bus_names_.push_back("bus "s + std::to_string(bus));
+            buses_.push_back({stops, is_roundtrip});
+            catalogue_.AddBus(bus_names_.back(), names, is_roundtrip);
+        }
+        catalogue_.Finalize();
+        router_ = std::make_unique<transport_router::TransportRouter>(MakeSettings(), catalogue_);
+        FindRides();
+    }
+
+    const transport_router::TransportRouter& GetRouter() const {
+        return *router_;
+    }
+    std::string_view GetStopName(size_t stop) const {
+        return stop_names_[stop];
+    }
+
+    // Time and number of waits of every loopless itinerary from one stop to another.
+    std::vector<std::pair<long long, size_t>> GetItineraries(size_t from, size_t to) const {
+        std::vector<std::pair<long long, size_t>> itineraries;
+        std::vector<bool> visited(STOP_COUNT);
+        visited[from] = true;
+        AddItineraries(from, to, visited, 0.0, 0, itineraries);
+        return itineraries;
+    }
+
+private:
+    struct Bus {
+        std::vector<size_t> stops;
+        bool is_roundtrip;
+    };
+
+    std::vector<std::string> stop_names_;
+    std::vector<std::string> bus_names_;
+    std::vector<Bus> buses_;
+    transport_catalogue::TransportCatalogue catalogue_;
+    std::unique_ptr<transport_router::TransportRouter> router_;
+    // Quickest ride time by (from, to, bus); repeated stops of a roundtrip give several.
+    std::map<std::tuple<size_t, size_t, size_t>, double> rides_;
+
+    double GetDistance(size_t from, size_t to) const {
+        return catalogue_.GetDistance(catalogue_.FindStop(stop_names_[from]), catalogue_.FindStop(stop_names_[to]));
+    }
+
+    void AddRide(size_t from, size_t to, size_t bus, double distance) {
+        const double time = 6 + distance * MINUTES_PER_METER;
+        const auto [iter, is_new] = rides_.emplace(std::tuple{from, to, bus}, time);
+        if (!is_new) {
+            iter->second = std::min(iter->second, time);
+        }
+    }
+
+    void FindRides() {
+        for (size_t bus = 0; bus < buses_.size(); ++bus) {
+            const auto& stops = buses_[bus].stops;
+            for (size_t i = 0; i < stops.size(); ++i) {
+                double forward = 0.0;
+                double backward = 0.0;
+                for (size_t j = i + 1; j < stops.size(); ++j) {
+                    forward += GetDistance(stops[j - 1], stops[j]);
+                    backward += GetDistance(stops[j], stops[j - 1]);
+                    AddRide(stops[i], stops[j], bus, forward);
+                    if (!buses_[bus].is_roundtrip) {
+                        AddRide(stops[j], stops[i], bus, backward);
+                    }
+                }
+            }
+        }
+    }
+
+    void AddItineraries(size_t stop, size_t to, std::vector<bool>& visited, double time, size_t waits,
+                        std::vector<std::pair<long long, size_t>>& itineraries) const {
+        if (stop == to) {
+            itineraries.emplace_back(ToMicroseconds(time), waits);
+            return;
+        }
+        for (const auto& [ride, ride_time] : rides_) {
+            const auto [ride_from, ride_to, bus] = ride;
+            if (ride_from != stop || visited[ride_to]) {
+                continue;
+            }
+            visited[ride_to] = true;
+            AddItineraries(ride_to, to, visited, time + ride_time, waits + 1, itineraries);
+            visited[ride_to] = false;
+        }
+    }
+};
+
+constexpr unsigned RANDOM_NETWORK_COUNT = 40;
+
+void TestParetoFrontOnRandomNetworks() {
+    for (unsigned seed = 1; seed <= RANDOM_NETWORK_COUNT; ++seed) {
+        const RandomNetwork network(seed);
+        for (size_t from = 0; from < RandomNetwork::STOP_COUNT; ++from) {
+            for (size_t to = 0; to < RandomNetwork::STOP_COUNT; ++to) {
+                if (from == to) {
+                    continue;
+                }
+                // Itineraries no other one is at least as good as in both time and waits.
+                auto itineraries = network.GetItineraries(from, to);
+                std::sort(itineraries.begin(), itineraries.end());
+                std::vector<std::pair<long long, size_t>> expected;
+                for (const auto& itinerary : itineraries) {
+                    if (expected.empty() || itinerary.second < expected.back().second) {
+                        expected.push_back(itinerary);
+                    }
+                }
+
+                const auto front = network.GetRouter().GetParetoRoutes(network.GetStopName(from), network.GetStopName(to));
+                std::vector<std::pair<long long, size_t>> actual;
+                for (const auto& route : front) {
+                    CheckRouteShape(route, network.GetStopName(from));
+                    actual.emplace_back(ToMicroseconds(GetTotalTime(route)), CountWaits(route));
+                }
+                const std::string hint = "seed "s + std::to_string(seed) + ", from "s + std::to_string(from)
+                                       + " to "s + std::to_string(to);
+                ASSERT_HINT(actual == expected, hint);
+            }
+        }
+    }
+}
+
+void TestAlternativesOnRandomNetworks() {
+    for (unsigned seed = 1; seed <= RANDOM_NETWORK_COUNT; ++seed) {
+        const RandomNetwork network(seed);
+        for (size_t from = 0; from < RandomNetwork::STOP_COUNT; ++from) {
+            for (size_t to = 0; to < RandomNetwork::STOP_COUNT; ++to) {
+                if (from == to) {
+                    continue;
+                }
+                auto itineraries = network.GetItineraries(from, to);
+                std::sort(itineraries.begin(), itineraries.end());
+                const std::string hint = "seed "s + std::to_string(seed) + ", from "s + std::to_string(from)
+                                       + " to "s + std::to_string(to);
+
+                // Asking for more routes than there are returns every loopless one.
+                for (const size_t max_count : {size_t{3}, itineraries.size() + 5}) {
+                    const auto routes = network.GetRouter().GetAlternativeRoutes(
+                        network.GetStopName(from), network.GetStopName(to), max_count);
+                    ASSERT_EQUAL_HINT(routes.size(), std::min(max_count, itineraries.size()), hint);
+                    std::set<std::vector<std::tuple<graph::VertexId, graph::VertexId, std::string_view>>> hops;
+                    for (size_t i = 0; i < routes.size(); ++i) {
+                        CheckRouteShape(routes[i], network.GetStopName(from));
+                        const long long time = ToMicroseconds(GetTotalTime(routes[i]));
+                        ASSERT_EQUAL_HINT(time, itineraries[i].first, hint);
+                        if (i > 0) {
+                            ASSERT_HINT(ToMicroseconds(GetTotalTime(routes[i - 1])) <= time, hint);
+                        }
+                        std::vector<std::tuple<graph::VertexId, graph::VertexId, std::string_view>> route_hops;
+                        for (const auto* edge : routes[i]) {
+                            route_hops.emplace_back(edge->from, edge->to, edge->name);
+                        }
+                        ASSERT_HINT(hops.insert(route_hops).second, "a route repeats, "s + hint);
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+int main() {
+    testing::TestRunner runner;
+    RUN_TEST(runner, TestRouteOnOneBus);
+    RUN_TEST(runner, TestRouteWithTransfer);
+    RUN_TEST(runner, TestTrivialAndMissingRoutes);
+    RUN_TEST(runner, TestRouteCache);
+    RUN_TEST(runner, TestRepeatedStopNames);
+    RUN_TEST(runner, TestParetoFrontOfTradeOffs);
+    RUN_TEST(runner, TestAlternativesOfTradeOffs);
+    RUN_TEST(runner, TestAlternativesBeyondAvailablePaths);
+    RUN_TEST(runner, TestParetoFrontOnRandomNetworks);
+    RUN_TEST(runner, TestAlternativesOnRandomNetworks);
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
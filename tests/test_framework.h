@@ -0,0 +1,83 @@
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Minimal assertions for the test executables: a failed check throws with the place and
+// the values that differ, and TestRunner counts the failed tests so main can return nonzero.
+namespace testing {
+
+class AssertionError : public std::logic_error {
+public:
+    using logic_error::logic_error;
+};
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& lhs, const U& rhs, const std::string& lhs_text, const std::string& rhs_text,
+                     const std::string& file, unsigned line, const std::string& hint) {
+    if (!(lhs == rhs)) {
+        std::ostringstream message;
+        message << file << ":" << line << ": ASSERT_EQUAL(" << lhs_text << ", " << rhs_text << ") failed: "
+                << lhs << " != " << rhs;
+        if (!hint.empty()) {
+            message << ". " << hint;
+        }
+        throw AssertionError(message.str());
+    }
+}
+
+inline void AssertImpl(bool value, const std::string& text, const std::string& file, unsigned line,
+                       const std::string& hint) {
+    if (!value) {
+        std::ostringstream message;
+        message << file << ":" << line << ": ASSERT(" << text << ") failed";
+        if (!hint.empty()) {
+            message << ". " << hint;
+        }
+        throw AssertionError(message.str());
+    }
+}
+
+class TestRunner {
+public:
+    template <typename TestFunc>
+    void RunTest(TestFunc func, const std::string& name) {
+        try {
+            func();
+            std::cerr << name << " OK\n";
+        } catch (const std::exception& e) {
+            ++fail_count_;
+            std::cerr << name << " failed: " << e.what() << "\n";
+        }
+    }
+
+    int GetFailCount() const {
+        return fail_count_;
+    }
+
+private:
+    int fail_count_ = 0;
+};
+
+}
+
+#define ASSERT_EQUAL(a, b) testing::AssertEqualImpl((a), (b), #a, #b, __FILE__, __LINE__, "")
+#define ASSERT_EQUAL_HINT(a, b, hint) testing::AssertEqualImpl((a), (b), #a, #b, __FILE__, __LINE__, (hint))
+#define ASSERT(expr) testing::AssertImpl(!!(expr), #expr, __FILE__, __LINE__, "")
+#define ASSERT_HINT(expr, hint) testing::AssertImpl(!!(expr), #expr, __FILE__, __LINE__, (hint))
+
+#define ASSERT_THROWS(expr, exception_type)                                                          \
+    do {                                                                                             \
+        bool is_thrown = false;                                                                      \
+        try {                                                                                        \
+            expr;                                                                                    \
+        } catch (const exception_type&) {                                                            \
+            is_thrown = true;                                                                        \
+        }                                                                                            \
+        testing::AssertImpl(is_thrown, #expr " throws " #exception_type, __FILE__, __LINE__, ""); \
+    } while (false)
+
+#define RUN_TEST(runner, func) runner.RunTest(func, #func)
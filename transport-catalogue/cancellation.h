@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+namespace cancellation {
+
+class DeadlineExceeded : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Time budget of one request. Long loops call Check on every iteration and stop with
+// DeadlineExceeded once the budget is spent; the clock is only read every CHECK_INTERVAL
+// calls. A default-constructed deadline never expires and may be shared between threads,
+// one with a budget belongs to the thread answering its request.
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Deadline() = default;
+
+    explicit Deadline(Clock::duration budget)
+        : expires_at_(Clock::now() + budget) {
+    }
+
+    bool IsExpired() const {
+        return expires_at_ && Clock::now() >= *expires_at_;
+    }
+
+    void Check() const {
+        if (expires_at_ && ++calls_ % CHECK_INTERVAL == 0) {
+            ThrowIfExpired();
+        }
+    }
+
+    void ThrowIfExpired() const {
+        if (IsExpired()) {
+            throw DeadlineExceeded("Request time budget exceeded");
+        }
+    }
+
+private:
+    static constexpr uint32_t CHECK_INTERVAL = 64;
+
+    std::optional<Clock::time_point> expires_at_;
+    mutable uint32_t calls_ = 0;
+};
+
+}
@@ -0,0 +1,177 @@
+#include "catalogue_versions.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace catalogue_versions {
+
+Snapshot::Snapshot(uint64_t version, const map_renderer::MapRenderer& renderer,
+                   const transport_router::RoutingSettings& routing_settings)
+    : version_(version)
+    , renderer_(renderer)
+    , routing_settings_(routing_settings)
+    , router_(routing_settings_, catalogue_)
+    , handler_(renderer_, catalogue_, router_) {
+}
+
+uint64_t Snapshot::GetVersion() const {
+    return version_;
+}
+
+const transport_catalogue::TransportCatalogue& Snapshot::GetCatalogue() const {
+    return catalogue_;
+}
+
+const transport_router::TransportRouter& Snapshot::GetRouter() const {
+    return router_;
+}
+
+const RequestHandler& Snapshot::GetHandler() const {
+    return handler_;
+}
+
+std::unique_ptr<Snapshot> Snapshot::Load(JsonReader& reader) {
+    auto snapshot = std::make_unique<Snapshot>(1, reader.MakeRenderer(), reader.MakeRoutingSettings());
+    reader.PopulateCatalogue(snapshot->catalogue_);
+    if (snapshot->routing_settings_.bus_velocity > 0) {
+        snapshot->router_.EnsureBuilt();
+    }
+    return snapshot;
+}
+
+std::unique_ptr<Snapshot> Snapshot::Apply(const CatalogueEdit& edit) const {
+    auto next = std::make_unique<Snapshot>(version_ + 1, renderer_, routing_settings_);
+    transport_catalogue::TransportCatalogue& catalogue = next->catalogue_;
+
+    // Existing stops keep their order, and so their ids unless a repeated name shadowed an
+    // earlier stop; moved stops get the new coordinates.
+    std::unordered_map<std::string_view, geo::Coordinates> moved_stops;
+    for (const auto& [name, coordinates] : edit.stops) {
+        moved_stops.emplace(name, coordinates);
+    }
+    // Indexed by id; shadowed stops stay null and are dropped.
+    std::vector<const domain::Stop*> stops(catalogue_.GetStopCount());
+    for (const auto& [name, stop] : catalogue_.GetAllStops()) {
+        stops[stop->id] = stop;
+    }
+    for (const domain::Stop* stop : stops) {
+        if (!stop) {
+            continue;
+        }
+        const auto moved_iter = moved_stops.find(stop->name);
+        catalogue.AddStop(stop->name, moved_iter != moved_stops.end() ? moved_iter->second : stop->coordinates);
+    }
+    for (const auto& [name, coordinates] : edit.stops) {
+        if (!catalogue.FindStop(name)) {
+            catalogue.AddStop(name, coordinates);
+        }
+    }
+
+    // SetDistance keeps the first length given for a pair, so edits go before the old lengths.
+    for (const auto& [from, to, length] : edit.distances) {
+        catalogue.SetDistance(from, to, length);
+    }
+    for (const auto& [stops_pair, length] : catalogue_.GetAllDistances()) {
+        const auto& [from, to] = stops_pair;
+        if (catalogue_.FindStop(from->name) == from && catalogue_.FindStop(to->name) == to) {
+            catalogue.SetDistance(from->name, to->name, length);
+        }
+    }
+
+    std::unordered_set<std::string_view> replaced_buses(edit.removed_buses.begin(), edit.removed_buses.end());
+    for (const auto& bus : edit.buses) {
+        replaced_buses.insert(bus.name);
+    }
+    std::vector<const domain::Bus*> buses(catalogue_.GetBusCount());
+    for (const auto& [name, bus] : catalogue_.GetAllBuses()) {
+        buses[bus->id] = bus;
+    }
+    for (const domain::Bus* bus : buses) {
+        if (!bus || replaced_buses.count(bus->name) > 0) {
+            continue;
+        }
+        std::vector<const domain::Stop*> bus_stops;
+        bus_stops.reserve(bus->stops.size());
+        for (const domain::Stop* stop : bus->stops) {
+            bus_stops.push_back(catalogue.FindStop(stop->name));
+        }
+        catalogue.AddBus(bus->name, std::move(bus_stops), bus->is_roundtrip);
+    }
+    for (const auto& bus : edit.buses) {
+        catalogue.AddBus(bus.name, std::vector<std::string_view>(bus.stops.begin(), bus.stops.end()), bus.is_roundtrip);
+    }
+
+    catalogue.Finalize();
+    if (routing_settings_.bus_velocity > 0) {
+        next->router_.EnsureBuilt();
+    }
+    return next;
+}
+
+CatalogueVersions::ReadGuard::~ReadGuard() {
+    versions_.Unpin(epoch_);
+}
+
+CatalogueVersions::CatalogueVersions(std::unique_ptr<Snapshot> initial)
+    : current_(initial.release()) {
+}
+
+CatalogueVersions::~CatalogueVersions() {
+    delete current_.load();
+}
+
+// A reader counts itself in the current epoch and keeps the count only if no writer
+// flipped the epoch meanwhile; a writer flips it after swapping the snapshot, so every
+// reader that may still see the old snapshot is in the counter the writer drains.
+CatalogueVersions::ReadGuard CatalogueVersions::Read() const {
+    while (true) {
+        const uint64_t epoch = epoch_.load();
+        std::atomic<size_t>& readers = readers_[epoch % 2];
+        readers.fetch_add(1);
+        if (epoch_.load() == epoch) {
+            return ReadGuard(*this, epoch, current_.load());
+        }
+        Unpin(epoch);
+    }
+}
+
+// The writer flips the epoch before it checks the counter, so either it sees this
+// decrement or the reader sees the flip and wakes it. The lock orders the wakeup after
+// the writer's check.
+void CatalogueVersions::Unpin(uint64_t epoch) const {
+    if (readers_[epoch % 2].fetch_sub(1) == 1 && epoch_.load() != epoch) {
+        std::lock_guard guard(drained_mutex_);
+        drained_.notify_all();
+    }
+}
+
+uint64_t CatalogueVersions::Publish(const CatalogueEdit& edit) {
+    std::lock_guard guard(writer_mutex_);
+    const Snapshot* previous = current_.load();
+    std::unique_ptr<Snapshot> next = previous->Apply(edit);
+    const uint64_t version = next->GetVersion();
+    current_.store(next.release());
+
+    const uint64_t epoch = epoch_.fetch_add(1);
+    const std::atomic<size_t>& readers = readers_[epoch % 2];
+    std::unique_lock lock(drained_mutex_);
+    drained_.wait(lock, [&readers] {
+        return readers.load() == 0;
+    });
+    lock.unlock();
+    delete previous;
+    return version;
+}
+
+std::future<uint64_t> CatalogueVersions::PublishAsync(CatalogueEdit edit) {
+    return std::async(std::launch::async, [this, edit = std::move(edit)] {
+        return Publish(edit);
+    });
+}
+
+uint64_t CatalogueVersions::GetVersion() const {
+    return Read()->GetVersion();
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "geo.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace catalogue_versions {
+
+// Changes applied on top of a version. Stops and buses with existing names replace them,
+// road distances given here override the old ones, buses are described as in base_requests.
+struct CatalogueEdit {
+    struct BusLine {
+        std::string name;
+        std::vector<std::string> stops;
+        bool is_roundtrip = false;
+    };
+
+    std::vector<std::pair<std::string, geo::Coordinates>> stops;
+    std::vector<std::tuple<std::string, std::string, int>> distances;
+    std::vector<BusLine> buses;
+    std::vector<std::string> removed_buses;
+};
+
+// One immutable version of the catalogue with its renderer and a fully built router.
+class Snapshot {
+public:
+    Snapshot(uint64_t version, const map_renderer::MapRenderer& renderer,
+             const transport_router::RoutingSettings& routing_settings);
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    uint64_t GetVersion() const;
+    const transport_catalogue::TransportCatalogue& GetCatalogue() const;
+    const transport_router::TransportRouter& GetRouter() const;
+    const RequestHandler& GetHandler() const;
+
+    // Next version: a copy of this one with edit applied, finalized and with its router built.
+    std::unique_ptr<Snapshot> Apply(const CatalogueEdit& edit) const;
+    // First version, populated from a reader's base requests and settings.
+    static std::unique_ptr<Snapshot> Load(JsonReader& reader);
+
+private:
+    const uint64_t version_;
+    const map_renderer::MapRenderer renderer_;
+    const transport_router::RoutingSettings routing_settings_;
+    transport_catalogue::TransportCatalogue catalogue_;
+    transport_router::TransportRouter router_;
+    RequestHandler handler_;
+};
+
+// Publishes snapshots RCU-style: readers pin the current version with two atomic
+// increments and never wait, while a writer builds the next version off to the side,
+// swaps it in and sleeps until the readers that pinned the old one are done. Only the
+// last of those readers takes a lock, to wake the writer.
+class CatalogueVersions {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+        const Snapshot& operator*() const {
+            return *snapshot_;
+        }
+        const Snapshot* operator->() const {
+            return snapshot_;
+        }
+
+    private:
+        friend class CatalogueVersions;
+
+        ReadGuard(const CatalogueVersions& versions, uint64_t epoch, const Snapshot* snapshot)
+            : versions_(versions)
+            , epoch_(epoch)
+            , snapshot_(snapshot) {
+        }
+
+        const CatalogueVersions& versions_;
+        const uint64_t epoch_;
+        const Snapshot* snapshot_;
+    };
+
+    explicit CatalogueVersions(std::unique_ptr<Snapshot> initial);
+    ~CatalogueVersions();
+
+    CatalogueVersions(const CatalogueVersions&) = delete;
+    CatalogueVersions& operator=(const CatalogueVersions&) = delete;
+
+    // The version stays valid, and unchanged, until the guard is destroyed.
+    ReadGuard Read() const;
+
+    // Builds and publishes the next version; returns its number once the previous one is freed.
+    // Waits for readers of the previous version, so the calling thread must not hold a ReadGuard.
+    uint64_t Publish(const CatalogueEdit& edit);
+    // Same as Publish, on a background thread.
+    std::future<uint64_t> PublishAsync(CatalogueEdit edit);
+
+    uint64_t GetVersion() const;
+
+private:
+    std::mutex writer_mutex_;
+    std::atomic<const Snapshot*> current_;
+    std::atomic<uint64_t> epoch_ = 0;
+    // Readers that pinned a snapshot during an even or an odd epoch.
+    mutable std::array<std::atomic<size_t>, 2> readers_{};
+    // Signalled when the readers of an epoch that is no longer current drop to zero.
+    mutable std::mutex drained_mutex_;
+    mutable std::condition_variable drained_;
+
+    void Unpin(uint64_t epoch) const;
+};
+
+}
@@ -0,0 +1,186 @@
+#include "city_registry.h"
+#include "instrumentation.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace city_registry {
+
+using namespace std::literals;
+
+City::City(const std::string& path)
+    : reader_(JsonReader::FromFile(path))
+    , has_render_settings_(reader_.GetRenderSettings().IsDict())
+    , has_routing_settings_(reader_.GetRoutingSettings().IsDict())
+    , renderer_(reader_.MakeRenderer())
+    , router_(reader_.MakeRoutingSettings(), catalogue_)
+    , handler_(renderer_, catalogue_, router_) {
+    reader_.PopulateCatalogue(catalogue_);
+    reader_.ReleaseInput();
+}
+
+std::optional<json::Node> City::ProcessStatRequest(const json::Dict& request_map) const {
+    const std::string_view type = request_map.at("type"sv).AsString();
+    if (type == "Map"sv && !has_render_settings_) {
+        return JsonReader::PrintMissingSettingsError(request_map.at("id"sv).AsInt(), "render_settings"sv);
+    }
+    if (type == "Route"sv && !has_routing_settings_) {
+        return JsonReader::PrintMissingSettingsError(request_map.at("id"sv).AsInt(), "routing_settings"sv);
+    }
+    return reader_.ProcessStatRequest(request_map, handler_);
+}
+
+bool City::IsRouterBuilt() const {
+    return router_.IsBuilt();
+}
+
+memory_usage::MemoryReport City::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Append("catalogue", catalogue_.GetMemoryUsage());
+    report.Append("router", router_.GetMemoryUsage());
+    return report;
+}
+
+void CityRegistry::Register(std::string name, std::string path) {
+    std::lock_guard guard(mutex_);
+    auto region = std::make_unique<Region>();
+    region->path = std::move(path);
+    if (!regions_.emplace(std::move(name), std::move(region)).second) {
+        throw std::logic_error("Region is registered twice"s);
+    }
+}
+
+CityRegistry::Region* CityRegistry::FindRegion(std::string_view name) const {
+    const auto region_iter = regions_.find(std::string{name});
+    return region_iter != regions_.end() ? region_iter->second.get() : nullptr;
+}
+
+std::shared_ptr<const City> CityRegistry::Acquire(std::string_view name) {
+    Region* region = nullptr;
+    {
+        std::lock_guard guard(mutex_);
+        region = FindRegion(name);
+        if (!region) {
+            return nullptr;
+        }
+        region->last_use = ++use_clock_;
+        if (region->city) {
+            return region->city;
+        }
+    }
+
+    std::lock_guard load_guard(region->load_mutex);
+    {
+        std::lock_guard guard(mutex_);
+        if (region->city) {
+            return region->city;
+        }
+    }
+    std::shared_ptr<const City> city;
+    {
+        instrumentation::ScopedTimer timer("CityRegistry: load region"sv);
+        city = std::make_shared<const City>(region->path);
+    }
+    std::lock_guard guard(mutex_);
+    region->city = city;
+    EvictOverBudget(region);
+    return city;
+}
+
+std::optional<json::Node> CityRegistry::ProcessStatRequest(const json::Dict& request_map) {
+    const std::string_view region_name = request_map.at("region"sv).AsString();
+    const std::shared_ptr<const City> city = Acquire(region_name);
+    if (!city) {
+        return JsonReader::PrintNotFoundError(request_map.at("id"sv).AsInt());
+    }
+    const bool had_router = city->IsRouterBuilt();
+    auto response = city->ProcessStatRequest(request_map);
+    // A first route query builds the all-pairs router, by far the largest structure of a region.
+    if (!had_router && city->IsRouterBuilt()) {
+        std::lock_guard guard(mutex_);
+        EvictOverBudget(FindRegion(region_name));
+    }
+    return response;
+}
+
+size_t CityRegistry::GetLoadedCount() const {
+    std::lock_guard guard(mutex_);
+    size_t count = 0;
+    for (const auto& [name, region] : regions_) {
+        count += region->city != nullptr;
+    }
+    return count;
+}
+
+size_t CityRegistry::GetMemoryBudget() const {
+    return memory_budget_;
+}
+
+size_t CityRegistry::GetMemoryUsage() const {
+    std::lock_guard guard(mutex_);
+    size_t bytes = 0;
+    for (const auto& [name, region] : regions_) {
+        if (region->city) {
+            bytes += region->city->GetMemoryUsage().GetTotalBytes();
+        }
+    }
+    return bytes;
+}
+
+void CityRegistry::EvictOverBudget(const Region* keep) {
+    size_t total = 0;
+    for (const auto& [name, region] : regions_) {
+        if (region->city) {
+            total += region->city->GetMemoryUsage().GetTotalBytes();
+        }
+    }
+    while (total > memory_budget_) {
+        Region* oldest = nullptr;
+        for (const auto& [name, region] : regions_) {
+            if (region->city && region.get() != keep && (!oldest || region->last_use < oldest->last_use)) {
+                oldest = region.get();
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        total -= oldest->city->GetMemoryUsage().GetTotalBytes();
+        oldest->city.reset();
+    }
+}
+
+std::unique_ptr<CityRegistry> LoadManifest(const std::string& path) {
+    std::ifstream input(path);
+    if (!input) {
+        throw std::runtime_error("Cannot open "s + path);
+    }
+    const json::Document manifest = json::Load(input);
+    const json::Dict& manifest_map = manifest.GetRoot().AsDict();
+
+    size_t memory_budget = std::numeric_limits<size_t>::max();
+    if (const auto budget_iter = manifest_map.find("memory_budget_mb"sv); budget_iter != manifest_map.end()) {
+        static constexpr size_t BYTES_PER_MB = 1024 * 1024;
+        const int memory_budget_mb = budget_iter->second.AsInt();
+        if (memory_budget_mb < 0) {
+            throw std::invalid_argument("Invalid memory_budget_mb: expected a non-negative number"s);
+        }
+        if (static_cast<size_t>(memory_budget_mb) > std::numeric_limits<size_t>::max() / BYTES_PER_MB) {
+            throw std::invalid_argument("Invalid memory_budget_mb: too large"s);
+        }
+        memory_budget = static_cast<size_t>(memory_budget_mb) * BYTES_PER_MB;
+    }
+    auto registry = std::make_unique<CityRegistry>(memory_budget);
+
+    const std::filesystem::path base_dir = std::filesystem::path(path).parent_path();
+    for (const auto& [name, region_path] : manifest_map.at("regions"sv).AsDict()) {
+        std::filesystem::path input_path(std::string{region_path.AsString()});
+        if (input_path.is_relative()) {
+            input_path = base_dir / input_path;
+        }
+        registry->Register(name, input_path.string());
+    }
+    return registry;
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "memory_usage.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace city_registry {
+
+// Catalogue, renderer and router of one region, loaded from a complete input file.
+// Immutable once constructed apart from the router, which builds itself on the first route,
+// and the stop name search, built on the first StopSearch. Map and Route requests for a
+// region without render_settings or routing_settings get an error response.
+class City {
+public:
+    explicit City(const std::string& path);
+
+    City(const City&) = delete;
+    City& operator=(const City&) = delete;
+
+    std::optional<json::Node> ProcessStatRequest(const json::Dict& request_map) const;
+    bool IsRouterBuilt() const;
+    // Counts the lazily built structures once they are built, so it is safe to call
+    // while requests are being answered.
+    memory_usage::MemoryReport GetMemoryUsage() const;
+
+private:
+    JsonReader reader_;
+    const bool has_render_settings_;
+    const bool has_routing_settings_;
+    transport_catalogue::TransportCatalogue catalogue_;
+    map_renderer::MapRenderer renderer_;
+    transport_router::TransportRouter router_;
+    RequestHandler handler_;
+};
+
+// Named regions served by one process. A region is loaded on its first request and,
+// when the loaded regions exceed the memory budget, the least recently used ones are
+// dropped; requests already holding a City keep it alive until they finish.
+class CityRegistry {
+public:
+    explicit CityRegistry(size_t memory_budget = std::numeric_limits<size_t>::max())
+        : memory_budget_(memory_budget) {
+    }
+
+    CityRegistry(const CityRegistry&) = delete;
+    CityRegistry& operator=(const CityRegistry&) = delete;
+
+    void Register(std::string name, std::string path);
+
+    // The loaded region, or nullptr when no region has this name. Safe to call from several threads.
+    std::shared_ptr<const City> Acquire(std::string_view name);
+
+    // Answers a request with a "region" field; unknown regions get the "not found" response.
+    std::optional<json::Node> ProcessStatRequest(const json::Dict& request_map);
+
+    size_t GetLoadedCount() const;
+    size_t GetMemoryBudget() const;
+    size_t GetMemoryUsage() const;
+
+private:
+    // city and last_use are guarded by the registry mutex; load_mutex lets one
+    // thread load the region while others wait for it without blocking the registry.
+    struct Region {
+        std::string path;
+        std::mutex load_mutex;
+        std::shared_ptr<const City> city;
+        uint64_t last_use = 0;
+    };
+
+    const size_t memory_budget_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Region>> regions_;
+    uint64_t use_clock_ = 0;
+
+    Region* FindRegion(std::string_view name) const;
+    // Requires mutex_ to be held.
+    void EvictOverBudget(const Region* keep);
+};
+
+// Builds a registry from a manifest {"regions": {"name": "input.json", ...}, "memory_budget_mb": 512}.
+// Relative input paths are resolved against the manifest's directory.
+std::unique_ptr<CityRegistry> LoadManifest(const std::string& path);
+
+}
@@ -2,20 +2,36 @@
 
 #include "geo.h"
 
-#include <string>
+#include <string_view>
 #include <vector>
 
 namespace domain {
 
+// Names are views into the owning catalogue's string pool.
 struct Stop {
-    std::string name;
+    std::string_view name;
     geo::Coordinates coordinates;
+    size_t id = 0;
+    geo::PreparedCoordinates prepared_coordinates;
 };
 
+// stops holds the route as given: a roundtrip ends at its first stop, a linear route
+// (is_roundtrip false) is stored one way and travelled there and back.
 struct Bus {
-    std::string name;
+    std::string_view name;
     std::vector<const Stop*> stops;
     bool is_roundtrip;
+    size_t id = 0;
+
+    // Stops visited in a full trip, 2n-1 for a linear route of n stops.
+    size_t GetRouteStopCount() const {
+        return is_roundtrip || stops.empty() ? stops.size() : 2 * stops.size() - 1;
+    }
+
+    // The index-th stop visited in a full trip; the way back of a linear route mirrors stops.
+    const Stop* GetRouteStop(size_t index) const {
+        return index < stops.size() ? stops[index] : stops[2 * stops.size() - 2 - index];
+    }
 };
 
 struct RouteInfo {
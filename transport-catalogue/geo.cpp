@@ -5,6 +5,13 @@
 
 namespace geo {
 
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double EARTH_RADIUS = 6371000;
+
+}
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     const double dr = M_PI / 180.0;
@@ -13,4 +20,38 @@ double ComputeDistance(Coordinates from, Coordinates to) {
         * 6371000;
 }
 
-}
\ No newline at end of file
+PreparedCoordinates Prepare(Coordinates point) {
+    const double lat_rad = point.lat * DEG_TO_RAD;
+    return {std::sin(lat_rad), std::cos(lat_rad), point.lng};
+}
+
+void CoordinatesSequence::Reserve(size_t count) {
+    lat_sin.reserve(count);
+    lat_cos.reserve(count);
+    lng.reserve(count);
+}
+
+void CoordinatesSequence::Add(const PreparedCoordinates& point) {
+    lat_sin.push_back(point.lat_sin);
+    lat_cos.push_back(point.lat_cos);
+    lng.push_back(point.lng);
+}
+
+size_t CoordinatesSequence::Size() const {
+    return lng.size();
+}
+
+// Iterations are independent and read plain arrays so the compiler can vectorize them.
+void ComputeDistances(const CoordinatesSequence& points, double* distances) {
+    const size_t count = points.Size();
+    const double* lat_sin = points.lat_sin.data();
+    const double* lat_cos = points.lat_cos.data();
+    const double* lng = points.lng.data();
+    for (size_t i = 1; i < count; ++i) {
+        distances[i - 1] = std::acos(lat_sin[i - 1] * lat_sin[i]
+                                     + lat_cos[i - 1] * lat_cos[i] * std::cos(std::abs(lng[i - 1] - lng[i]) * DEG_TO_RAD))
+            * EARTH_RADIUS;
+    }
+}
+
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdlib>
+#include <vector>
+
 namespace geo {
 
 struct Coordinates {
@@ -7,6 +10,30 @@ struct Coordinates {
     double lng;
 };
 
+// Latitude trigonometry computed once per point for repeated distance computations.
+// Longitude stays in degrees so results match ComputeDistance bit for bit.
+struct PreparedCoordinates {
+    double lat_sin = 0.0;
+    double lat_cos = 0.0;
+    double lng = 0.0;
+};
+
+// Structure-of-arrays form of a point sequence consumed by the batch kernels.
+struct CoordinatesSequence {
+    std::vector<double> lat_sin;
+    std::vector<double> lat_cos;
+    std::vector<double> lng;
+
+    void Reserve(size_t count);
+    void Add(const PreparedCoordinates& point);
+    size_t Size() const;
+};
+
 double ComputeDistance(Coordinates from, Coordinates to);
 
+PreparedCoordinates Prepare(Coordinates point);
+
+// Write the Size() - 1 distances between consecutive points to distances.
+void ComputeDistances(const CoordinatesSequence& points, double* distances);
+
 }
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "memory_usage.h"
 #include "ranges.h"
 
 #include <cstdlib>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -12,7 +15,7 @@ using EdgeId = size_t;
 
 template <typename Weight>
 struct Edge {
-    std::string name;
+    std::string_view name;
     size_t quality;
     VertexId from;
     VertexId to;
@@ -28,6 +31,7 @@ private:
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
     size_t GetVertexCount() const;
@@ -35,6 +39,8 @@ public:
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    memory_usage::MemoryReport GetMemoryUsage() const;
+
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
@@ -45,6 +51,15 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
     : incidence_lists_(vertex_count) {
 }
 
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges)
+    : edges_(std::move(edges))
+    , incidence_lists_(vertex_count) {
+    for (EdgeId id = 0; id < edges_.size(); ++id) {
+        incidence_lists_.at(edges_[id].from).push_back(id);
+    }
+}
+
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     edges_.push_back(edge);
@@ -73,4 +88,12 @@ typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
+
+template <typename Weight>
+memory_usage::MemoryReport DirectedWeightedGraph<Weight>::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Add("edges_", memory_usage::VectorBytes(edges_));
+    report.Add("incidence_lists_", memory_usage::VectorBytes(incidence_lists_));
+    return report;
+}
 }
\ No newline at end of file
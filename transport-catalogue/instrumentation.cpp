@@ -0,0 +1,286 @@
+#include "instrumentation.h"
+#include "json_builder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#ifdef TC_COUNT_ALLOCATIONS
+
+namespace {
+
+std::atomic<size_t> allocation_count = 0;
+std::atomic<size_t> allocation_bytes = 0;
+
+}
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+#endif
+
+namespace instrumentation {
+
+using namespace std::literals;
+
+namespace {
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double ToMicroseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+std::string_view ToString(EventKind kind) {
+    return kind == EventKind::PHASE ? "phase"sv : "request"sv;
+}
+
+}
+
+AllocationCounters GetAllocationCounters() {
+#ifdef TC_COUNT_ALLOCATIONS
+    return {allocation_count.load(std::memory_order_relaxed), allocation_bytes.load(std::memory_order_relaxed)};
+#else
+    return {};
+#endif
+}
+
+void LatencyHistogram::Add(Clock::duration duration) {
+    const auto microseconds = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0));
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKET_COUNT && (uint64_t{1} << bucket) <= microseconds) {
+        ++bucket;
+    }
+    ++buckets_[bucket];
+    ++count_;
+    total_ += duration;
+    max_ = std::max(max_, duration);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        buckets_[bucket] += other.buckets_[bucket];
+    }
+    count_ += other.count_;
+    total_ += other.total_;
+    max_ = std::max(max_, other.max_);
+}
+
+size_t LatencyHistogram::GetCount() const {
+    return count_;
+}
+
+double LatencyHistogram::GetTotalMs() const {
+    return ToMilliseconds(total_);
+}
+
+double LatencyHistogram::GetMaxMs() const {
+    return ToMilliseconds(max_);
+}
+
+double LatencyHistogram::GetPercentileMs(double quantile) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    const auto rank = static_cast<size_t>(quantile * (count_ - 1)) + 1;
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += buckets_[bucket];
+        if (seen >= rank) {
+            const double upper_bound_ms = static_cast<double>(uint64_t{1} << bucket) / 1000.0;
+            return std::min(upper_bound_ms, GetMaxMs());
+        }
+    }
+    return GetMaxMs();
+}
+
+Profiler& Profiler::Instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::Enable(bool is_tracing) {
+    std::lock_guard guard(mutex_);
+    origin_ = Clock::now();
+    is_tracing_.store(is_tracing, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+Profiler::ThreadRecords& Profiler::GetThreadRecords() {
+    thread_local ThreadRecords* records = nullptr;
+    if (!records) {
+        std::lock_guard guard(mutex_);
+        records_.push_back(std::make_unique<ThreadRecords>());
+        records = records_.back().get();
+        records->thread = records_.size();
+    }
+    return *records;
+}
+
+Profiler::PhaseStats& Profiler::FindPhase(Phases& phases, std::string_view name, Clock::time_point start) {
+    auto phase_iter = std::find_if(phases.begin(), phases.end(),
+                                   [name](const auto& phase) { return phase.first == name; });
+    if (phase_iter == phases.end()) {
+        phase_iter = phases.insert(phases.end(), {std::string{name}, {}});
+        phase_iter->second.first_start = start;
+    }
+    return phase_iter->second;
+}
+
+void Profiler::Record(std::string_view name, EventKind kind, Clock::time_point start, Clock::time_point end,
+                      const AllocationCounters& allocations) {
+    ThreadRecords& records = GetThreadRecords();
+    std::lock_guard guard(records.mutex);
+    if (kind == EventKind::PHASE) {
+        auto& stats = FindPhase(records.phases, name, start);
+        ++stats.calls;
+        stats.total += end - start;
+        stats.allocations.count += allocations.count;
+        stats.allocations.bytes += allocations.bytes;
+    } else {
+        auto request_iter = records.requests.find(name);
+        if (request_iter == records.requests.end()) {
+            request_iter = records.requests.emplace(std::string{name}, LatencyHistogram{}).first;
+        }
+        request_iter->second.Add(end - start);
+    }
+    if (is_tracing_.load(std::memory_order_relaxed)) {
+        records.events.push_back({std::string{name}, kind, start, end - start, records.thread});
+    }
+}
+
+std::pair<Profiler::Phases, Profiler::Requests> Profiler::Summarize() const {
+    Phases phases;
+    Requests requests;
+    std::lock_guard guard(mutex_);
+    for (const auto& records : records_) {
+        std::lock_guard records_guard(records->mutex);
+        for (const auto& [name, stats] : records->phases) {
+            auto& total_stats = FindPhase(phases, name, stats.first_start);
+            total_stats.calls += stats.calls;
+            total_stats.total += stats.total;
+            total_stats.allocations.count += stats.allocations.count;
+            total_stats.allocations.bytes += stats.allocations.bytes;
+            total_stats.first_start = std::min(total_stats.first_start, stats.first_start);
+        }
+        for (const auto& [type, histogram] : records->requests) {
+            requests[type].Merge(histogram);
+        }
+    }
+    std::stable_sort(phases.begin(), phases.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.first_start < rhs.second.first_start;
+    });
+    return {std::move(phases), std::move(requests)};
+}
+
+void Profiler::PrintTextReport(std::ostream& output) const {
+    const auto [phases, requests] = Summarize();
+    const auto flags = output.flags();
+    output << std::fixed << std::setprecision(3);
+    output << std::left << std::setw(32) << "phase" << std::right << std::setw(8) << "calls"
+           << std::setw(14) << "total, ms" << std::setw(14) << "allocations" << std::setw(16) << "allocated, B" << '\n';
+    for (const auto& [name, stats] : phases) {
+        output << std::left << std::setw(32) << name << std::right << std::setw(8) << stats.calls
+               << std::setw(14) << ToMilliseconds(stats.total) << std::setw(14) << stats.allocations.count
+               << std::setw(16) << stats.allocations.bytes << '\n';
+    }
+    output << '\n' << std::left << std::setw(12) << "request" << std::right << std::setw(10) << "count"
+           << std::setw(14) << "total, ms" << std::setw(12) << "p50, ms" << std::setw(12) << "p90, ms"
+           << std::setw(12) << "p99, ms" << std::setw(12) << "max, ms" << '\n';
+    for (const auto& [type, histogram] : requests) {
+        output << std::left << std::setw(12) << type << std::right << std::setw(10) << histogram.GetCount()
+               << std::setw(14) << histogram.GetTotalMs() << std::setw(12) << histogram.GetPercentileMs(0.5)
+               << std::setw(12) << histogram.GetPercentileMs(0.9) << std::setw(12) << histogram.GetPercentileMs(0.99)
+               << std::setw(12) << histogram.GetMaxMs() << '\n';
+    }
+    const AllocationCounters allocations = GetAllocationCounters();
+    output << "\nallocations: " << allocations.count << " (" << allocations.bytes << " bytes)\n";
+    output.flags(flags);
+}
+
+void Profiler::PrintJsonReport(std::ostream& output) const {
+    const auto [phases, requests] = Summarize();
+    json::Array phases_json;
+    for (const auto& [name, stats] : phases) {
+        phases_json.push_back(json::Builder{}
+            .StartDict()
+                .Key("name"s).Value(name)
+                .Key("calls"s).Value(static_cast<int>(stats.calls))
+                .Key("total_ms"s).Value(ToMilliseconds(stats.total))
+                .Key("allocations"s).Value(static_cast<double>(stats.allocations.count))
+                .Key("allocated_bytes"s).Value(static_cast<double>(stats.allocations.bytes))
+            .EndDict()
+        .Build());
+    }
+    json::Dict requests_json;
+    for (const auto& [type, histogram] : requests) {
+        requests_json.emplace(type, json::Builder{}
+            .StartDict()
+                .Key("count"s).Value(static_cast<int>(histogram.GetCount()))
+                .Key("total_ms"s).Value(histogram.GetTotalMs())
+                .Key("p50_ms"s).Value(histogram.GetPercentileMs(0.5))
+                .Key("p90_ms"s).Value(histogram.GetPercentileMs(0.9))
+                .Key("p99_ms"s).Value(histogram.GetPercentileMs(0.99))
+                .Key("max_ms"s).Value(histogram.GetMaxMs())
+            .EndDict()
+        .Build());
+    }
+    const AllocationCounters allocations = GetAllocationCounters();
+    json::Print(json::Document{json::Builder{}
+        .StartDict()
+            .Key("phases"s).Value(std::move(phases_json))
+            .Key("requests"s).Value(std::move(requests_json))
+            .Key("allocations"s).Value(static_cast<double>(allocations.count))
+            .Key("allocated_bytes"s).Value(static_cast<double>(allocations.bytes))
+        .EndDict()
+    .Build()}, output);
+    output << '\n';
+}
+
+void Profiler::PrintTrace(std::ostream& output) const {
+    std::lock_guard guard(mutex_);
+    json::Array events;
+    for (const auto& records : records_) {
+        std::lock_guard records_guard(records->mutex);
+        for (const auto& event : records->events) {
+            events.push_back(json::Builder{}
+                .StartDict()
+                    .Key("name"s).Value(event.name)
+                    .Key("cat"s).Value(std::string{ToString(event.kind)})
+                    .Key("ph"s).Value("X"s)
+                    .Key("ts"s).Value(ToMicroseconds(event.start - origin_))
+                    .Key("dur"s).Value(ToMicroseconds(event.duration))
+                    .Key("pid"s).Value(1)
+                    .Key("tid"s).Value(static_cast<int>(event.thread))
+                .EndDict()
+            .Build());
+        }
+    }
+    json::Print(json::Document{json::Builder{}
+        .StartDict()
+            .Key("traceEvents"s).Value(std::move(events))
+            .Key("displayTimeUnit"s).Value("ms"s)
+        .EndDict()
+    .Build()}, output);
+    output << '\n';
+}
+
+}
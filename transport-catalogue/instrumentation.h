@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace instrumentation {
+
+using Clock = std::chrono::steady_clock;
+
+// Process-wide allocation totals; they stay zero unless the build defines TC_COUNT_ALLOCATIONS.
+struct AllocationCounters {
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+AllocationCounters GetAllocationCounters();
+
+// Latencies bucketed by powers of two of microseconds.
+class LatencyHistogram {
+public:
+    void Add(Clock::duration duration);
+    void Merge(const LatencyHistogram& other);
+
+    size_t GetCount() const;
+    double GetTotalMs() const;
+    double GetMaxMs() const;
+    // Upper bound of the bucket holding the given quantile, never above the maximum.
+    double GetPercentileMs(double quantile) const;
+
+private:
+    static constexpr size_t BUCKET_COUNT = 40;
+
+    std::array<size_t, BUCKET_COUNT> buckets_{};
+    size_t count_ = 0;
+    Clock::duration total_{};
+    Clock::duration max_{};
+};
+
+enum class EventKind {
+    PHASE,
+    REQUEST,
+};
+
+// Collects phase timings, request latencies and, when tracing, trace events once enabled.
+// While disabled, timers cost a single relaxed atomic load. Every thread records into
+// its own buffer, and reports merge the buffers.
+class Profiler {
+public:
+    static Profiler& Instance();
+
+    void Enable(bool is_tracing);
+    bool IsEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void Record(std::string_view name, EventKind kind, Clock::time_point start, Clock::time_point end,
+                const AllocationCounters& allocations);
+
+    void PrintTextReport(std::ostream& output) const;
+    void PrintJsonReport(std::ostream& output) const;
+    // Chrome trace viewer (chrome://tracing, Perfetto) JSON.
+    void PrintTrace(std::ostream& output) const;
+
+private:
+    struct PhaseStats {
+        size_t calls = 0;
+        Clock::duration total{};
+        AllocationCounters allocations;
+        // Reports list phases in order of their first start.
+        Clock::time_point first_start;
+    };
+
+    struct TraceEvent {
+        std::string name;
+        EventKind kind;
+        Clock::time_point start;
+        Clock::duration duration;
+        size_t thread;
+    };
+
+    using Phases = std::vector<std::pair<std::string, PhaseStats>>;
+    using Requests = std::map<std::string, LatencyHistogram, std::less<>>;
+
+    // What one thread recorded. Only that thread writes it, so the mutex is contended
+    // by reports alone.
+    struct ThreadRecords {
+        size_t thread = 0;
+        std::mutex mutex;
+        Phases phases;
+        Requests requests;
+        std::vector<TraceEvent> events;
+    };
+
+    Profiler() = default;
+
+    std::atomic<bool> enabled_ = false;
+    std::atomic<bool> is_tracing_ = false;
+    Clock::time_point origin_;
+    // Guards the list of buffers, which outlive their threads.
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadRecords>> records_;
+
+    ThreadRecords& GetThreadRecords();
+    static PhaseStats& FindPhase(Phases& phases, std::string_view name, Clock::time_point start);
+    std::pair<Phases, Requests> Summarize() const;
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(std::string_view name, EventKind kind = EventKind::PHASE)
+        : name_(name)
+        , kind_(kind)
+        , is_active_(Profiler::Instance().IsEnabled()) {
+        if (is_active_) {
+            allocations_ = GetAllocationCounters();
+            start_ = Clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if (is_active_) {
+            const Clock::time_point end = Clock::now();
+            const AllocationCounters allocations = GetAllocationCounters();
+            Profiler::Instance().Record(name_, kind_, start_, end,
+                                        {allocations.count - allocations_.count, allocations.bytes - allocations_.bytes});
+        }
+    }
+
+private:
+    std::string_view name_;
+    EventKind kind_;
+    bool is_active_;
+    Clock::time_point start_;
+    AllocationCounters allocations_;
+};
+
+}
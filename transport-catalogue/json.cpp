@@ -1,80 +1,112 @@
 #include "json.h"
 
+#include <algorithm>
+#include <cctype>
 #include <iterator>
 
+#include "parallel.h"
+
 namespace json {
 
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
-
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
+// Character sources for the parser. Both report failure like an istream does:
+// after a read past the end the reader converts to false.
+class StreamReader {
+public:
+    explicit StreamReader(std::istream& input)
+        : input_(input) {
     }
-    return s;
-}
 
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
-
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+    bool ReadNonSpace(char& c) {
+        return static_cast<bool>(input_ >> c);
+    }
+    // Reads straight from the buffer like istreambuf_iterator, without a sentry per character.
+    bool Get(char& c) {
+        const auto ch = input_.rdbuf()->sbumpc();
+        if (std::char_traits<char>::eq_int_type(ch, std::char_traits<char>::eof())) {
+            input_.setstate(std::ios::eofbit | std::ios::failbit);
+            return false;
         }
-        result.push_back(LoadNode(input));
+        c = std::char_traits<char>::to_char_type(ch);
+        return true;
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+    int Peek() {
+        return input_.peek();
+    }
+    void PutBack(char c) {
+        input_.putback(c);
+    }
+    explicit operator bool() const {
+        return static_cast<bool>(input_);
     }
-    return Node(std::move(result));
-}
 
-Node LoadDict(std::istream& input) {
-    Dict dict;
+private:
+    std::istream& input_;
+};
 
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c + "' has been found"s);
-            }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+class BufferReader {
+public:
+    explicit BufferReader(std::string_view text)
+        : text_(text) {
+    }
+
+    bool ReadNonSpace(char& c) {
+        while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_]))) {
+            ++position_;
         }
+        return Get(c);
     }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
+    bool Get(char& c) {
+        if (position_ == text_.size()) {
+            is_good_ = false;
+            return false;
+        }
+        c = text_[position_++];
+        return true;
+    }
+    int Peek() const {
+        return position_ < text_.size() ? static_cast<unsigned char>(text_[position_]) : std::char_traits<char>::eof();
+    }
+    void PutBack(char) {
+        --position_;
+    }
+    explicit operator bool() const {
+        return is_good_;
     }
-    return Node(std::move(dict));
-}
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
+    // Rest of the input, used to scan a string without going through Get.
+    std::string_view GetRest() const {
+        return text_.substr(position_);
+    }
+    void Skip(size_t count) {
+        position_ += count;
+    }
+
+private:
+    std::string_view text_;
+    size_t position_ = 0;
+    bool is_good_ = true;
+};
+
+template <typename Reader>
+Node LoadNode(Reader& input, bool borrow_strings);
+
+template <typename Reader>
+std::string ReadStringBody(std::string s, Reader& input) {
     while (true) {
-        if (it == end) {
+        char ch;
+        if (!input.Get(ch)) {
             throw ParsingError("String parsing error");
         }
-        const char ch = *it;
         if (ch == '"') {
-            ++it;
             break;
         } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
+            char escaped_char;
+            if (!input.Get(escaped_char)) {
                 throw ParsingError("String parsing error");
             }
-            const char escaped_char = *(it);
             switch (escaped_char) {
                 case 'n':
                     s.push_back('\n');
@@ -99,13 +131,98 @@ Node LoadString(std::istream& input) {
         } else {
             s.push_back(ch);
         }
-        ++it;
     }
+    return s;
+}
+
+Node LoadString(StreamReader& input, bool) {
+    return Node(ReadStringBody(std::string{}, input));
+}
+
+// Strings without escapes are found with one scan and either borrowed or copied whole.
+Node LoadString(BufferReader& input, bool borrow_strings) {
+    const std::string_view rest = input.GetRest();
+    const size_t end = rest.find_first_of("\"\\\n\r"sv);
+    if (end != std::string_view::npos && rest[end] == '"') {
+        input.Skip(end + 1);
+        if (borrow_strings) {
+            return Node(BorrowedString{rest.substr(0, end)});
+        }
+        return Node(std::string{rest.substr(0, end)});
+    }
+    const size_t plain_size = std::min(end, rest.size());
+    input.Skip(plain_size);
+    return Node(ReadStringBody(std::string{rest.substr(0, plain_size)}, input));
+}
 
-    return Node(std::move(s));
+template <typename Reader>
+std::string LoadLiteral(Reader& input) {
+    std::string s;
+    for (char c; std::isalpha(input.Peek()) && input.Get(c);) {
+        s.push_back(c);
+    }
+    return s;
 }
 
-Node LoadBool(std::istream& input) {
+template <typename Reader>
+Node LoadArray(Reader& input, bool borrow_strings) {
+    std::vector<Node> result;
+
+    for (char c; input.ReadNonSpace(c) && c != ']';) {
+        if (c != ',') {
+            input.PutBack(c);
+        }
+        result.push_back(LoadNode(input, borrow_strings));
+    }
+    if (!input) {
+        throw ParsingError("Array parsing error"s);
+    }
+    return Node(std::move(result));
+}
+
+// Reads an object's items after its opening brace, each value with load_value.
+template <typename Reader, typename LoadValue>
+Node LoadDictWith(Reader& input, bool borrow_strings, LoadValue load_value) {
+    std::vector<Dict::value_type> items;
+
+    for (char c; input.ReadNonSpace(c) && c != '}';) {
+        if (c == '"') {
+            std::string key{LoadString(input, borrow_strings).AsString()};
+            if (input.ReadNonSpace(c) && c == ':') {
+                items.emplace_back(std::move(key), load_value());
+            } else {
+                throw ParsingError(": is expected but '"s + c + "' has been found"s);
+            }
+        } else if (c != ',') {
+            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+        }
+    }
+    if (!input) {
+        throw ParsingError("Dictionary parsing error"s);
+    }
+    // Sorting once is cheaper than keeping the items sorted while they arrive.
+    std::sort(items.begin(), items.end(), [](const Dict::value_type& lhs, const Dict::value_type& rhs) {
+        return lhs.first < rhs.first;
+    });
+    const auto duplicate = std::adjacent_find(items.begin(), items.end(),
+        [](const Dict::value_type& lhs, const Dict::value_type& rhs) {
+            return lhs.first == rhs.first;
+        });
+    if (duplicate != items.end()) {
+        throw ParsingError("Duplicate key '"s + duplicate->first + "' have been found");
+    }
+    return Node(Dict(sorted_unique, std::move(items)));
+}
+
+template <typename Reader>
+Node LoadDict(Reader& input, bool borrow_strings) {
+    return LoadDictWith(input, borrow_strings, [&input, borrow_strings] {
+        return LoadNode(input, borrow_strings);
+    });
+}
+
+template <typename Reader>
+Node LoadBool(Reader& input) {
     const auto s = LoadLiteral(input);
     if (s == "true"sv) {
         return Node{true};
@@ -116,7 +233,8 @@ Node LoadBool(std::istream& input) {
     }
 }
 
-Node LoadNull(std::istream& input) {
+template <typename Reader>
+Node LoadNull(Reader& input) {
     if (auto literal = LoadLiteral(input); literal == "null"sv) {
         return Node{nullptr};
     } else {
@@ -124,44 +242,46 @@ Node LoadNull(std::istream& input) {
     }
 }
 
-Node LoadNumber(std::istream& input) {
+template <typename Reader>
+Node LoadNumber(Reader& input) {
     std::string parsed_num;
 
     auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
+        char c;
+        if (!input.Get(c)) {
             throw ParsingError("Failed to read number from stream"s);
         }
+        parsed_num += c;
     };
 
     auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
+        if (!std::isdigit(input.Peek())) {
             throw ParsingError("A digit is expected"s);
         }
-        while (std::isdigit(input.peek())) {
+        while (std::isdigit(input.Peek())) {
             read_char();
         }
     };
 
-    if (input.peek() == '-') {
+    if (input.Peek() == '-') {
         read_char();
     }
-    if (input.peek() == '0') {
+    if (input.Peek() == '0') {
         read_char();
     } else {
         read_digits();
     }
 
     bool is_int = true;
-    if (input.peek() == '.') {
+    if (input.Peek() == '.') {
         read_char();
         read_digits();
         is_int = false;
     }
 
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
+    if (int ch = input.Peek(); ch == 'e' || ch == 'E') {
         read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
+        if (ch = input.Peek(); ch == '+' || ch == '-') {
             read_char();
         }
         read_digits();
@@ -181,32 +301,162 @@ Node LoadNumber(std::istream& input) {
     }
 }
 
-Node LoadNode(std::istream& input) {
+template <typename Reader>
+Node LoadNode(Reader& input, bool borrow_strings) {
     char c;
-    if (!(input >> c)) {
+    if (!input.ReadNonSpace(c)) {
         throw ParsingError("Unexpected EOF"s);
     }
     switch (c) {
         case '[':
-            return LoadArray(input);
+            return LoadArray(input, borrow_strings);
         case '{':
-            return LoadDict(input);
+            return LoadDict(input, borrow_strings);
         case '"':
-            return LoadString(input);
+            return LoadString(input, borrow_strings);
         case 't':
             [[fallthrough]];
         case 'f':
-            input.putback(c);
+            input.PutBack(c);
             return LoadBool(input);
         case 'n':
-            input.putback(c);
+            input.PutBack(c);
             return LoadNull(input);
         default:
-            input.putback(c);
+            input.PutBack(c);
             return LoadNumber(input);
     }
 }
 
+// Below this many bytes per thread a top-level array is not worth a pre-scan.
+constexpr size_t MIN_PARALLEL_CHUNK_BYTES = 1 << 20;
+
+// Offsets of an array's elements, found without parsing them: only strings and
+// nesting are tracked. text starts right after the opening bracket.
+struct ArrayLayout {
+    std::vector<size_t> element_starts;
+    size_t end = 0;  // offset of the closing bracket
+};
+
+ArrayLayout ScanArray(std::string_view text) {
+    ArrayLayout layout;
+    size_t depth = 0;
+    bool expects_element = true;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            continue;
+        }
+        if (depth == 0 && expects_element && c != ']') {
+            layout.element_starts.push_back(i);
+            expects_element = false;
+        }
+        switch (c) {
+            case '"':
+                for (i = text.find_first_of("\"\\"sv, i + 1); i != std::string_view::npos && text[i] == '\\';
+                     i = text.find_first_of("\"\\"sv, i + 2)) {
+                }
+                if (i == std::string_view::npos) {
+                    throw ParsingError("String parsing error"s);
+                }
+                break;
+            case '[':
+                [[fallthrough]];
+            case '{':
+                ++depth;
+                break;
+            case ']':
+                [[fallthrough]];
+            case '}':
+                if (depth == 0) {
+                    if (c != ']') {
+                        throw ParsingError("Array parsing error"s);
+                    }
+                    layout.end = i;
+                    return layout;
+                }
+                --depth;
+                break;
+            case ',':
+                expects_element = depth == 0;
+                break;
+        }
+    }
+    throw ParsingError("Array parsing error"s);
+}
+
+// Parses an array whose opening bracket was just read. Large arrays are split into
+// runs of whole elements of similar byte size, parsed concurrently and concatenated.
+Node LoadArrayParallel(BufferReader& input, size_t thread_count) {
+    const std::string_view text = input.GetRest();
+    if (thread_count < 2 || text.size() < 2 * MIN_PARALLEL_CHUNK_BYTES) {
+        return LoadArray(input, true);
+    }
+    const ArrayLayout layout = ScanArray(text);
+    const std::vector<size_t>& starts = layout.element_starts;
+    const size_t chunk_count = std::clamp<size_t>(
+        std::min(layout.end / MIN_PARALLEL_CHUNK_BYTES, starts.size()), 1, thread_count);
+
+    // Chunk k holds the elements starting in [k, k + 1) parts of the array's bytes.
+    std::vector<size_t> chunk_begins;
+    for (size_t chunk = 0; chunk <= chunk_count; ++chunk) {
+        const size_t target = layout.end / chunk_count * chunk;
+        chunk_begins.push_back(chunk == chunk_count
+            ? starts.size()
+            : static_cast<size_t>(std::lower_bound(starts.begin(), starts.end(), target) - starts.begin()));
+    }
+
+    std::vector<Array> chunks(chunk_count);
+    parallel::ForEachChunk(chunk_count, chunk_count, [&](size_t chunk, size_t, size_t) {
+        const size_t first = chunk_begins[chunk];
+        const size_t last = chunk_begins[chunk + 1];
+        Array& result = chunks[chunk];
+        result.reserve(last - first);
+        for (size_t element = first; element < last; ++element) {
+            const size_t end = element + 1 < starts.size() ? starts[element + 1] : layout.end;
+            BufferReader element_input(text.substr(starts[element], end - starts[element]));
+            result.push_back(LoadNode(element_input, true));
+            // The scan only finds where elements start, so a slice holding anything but
+            // the element and its comma means a missing comma or stray characters.
+            char c;
+            if (element_input.ReadNonSpace(c) && (c != ',' || element_input.ReadNonSpace(c))) {
+                throw ParsingError("Array parsing error"s);
+            }
+        }
+    });
+
+    Array result;
+    result.reserve(starts.size());
+    for (Array& chunk : chunks) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(result));
+    }
+    input.Skip(layout.end + 1);
+    return Node(std::move(result));
+}
+
+// Top-level arrays of a root object go through LoadArrayParallel, everything else as in LoadNode.
+Node LoadRootParallel(BufferReader& input, size_t thread_count) {
+    char c;
+    if (!input.ReadNonSpace(c)) {
+        throw ParsingError("Unexpected EOF"s);
+    }
+    if (c != '{') {
+        input.PutBack(c);
+        return LoadNode(input, true);
+    }
+    return LoadDictWith(input, true, [&input, thread_count] {
+        char c;
+        if (!input.ReadNonSpace(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        if (c == '[') {
+            return LoadArrayParallel(input, thread_count);
+        }
+        input.PutBack(c);
+        return LoadNode(input, true);
+    });
+}
+
 struct PrintContext {
     std::ostream& out;
     int indent_step = 4;
@@ -230,7 +480,7 @@ void PrintValue(const Value& value, const PrintContext& ctx) {
     ctx.out << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
+void PrintString(std::string_view value, std::ostream& out) {
     out.put('"');
     for (const char c : value) {
         switch (c) {
@@ -261,6 +511,11 @@ void PrintValue<std::string>(const std::string& value, const PrintContext& ctx)
     PrintString(value, ctx.out);
 }
 
+template <>
+void PrintValue<BorrowedString>(const BorrowedString& value, const PrintContext& ctx) {
+    PrintString(value.text, ctx.out);
+}
+
 template <>
 void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
     ctx.out << "null"sv;
@@ -324,11 +579,104 @@ void PrintNode(const Node& node, const PrintContext& ctx) {
 }
 
 Document Load(std::istream& input) {
-    return Document{LoadNode(input)};
+    StreamReader reader(input);
+    return Document{LoadNode(reader, false)};
+}
+
+Document LoadView(std::string_view text) {
+    BufferReader reader(text);
+    return Document{LoadNode(reader, true)};
+}
+
+Document LoadViewParallel(std::string_view text, size_t thread_count) {
+    BufferReader reader(text);
+    return Document{LoadRootParallel(reader, thread_count)};
 }
 
 void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+ObjectReader::ObjectReader(std::istream& input)
+    : input_(input) {
+    StreamReader reader(input_);
+    char c;
+    if (!reader.ReadNonSpace(c) || c != '{') {
+        throw ParsingError("Object is expected"s);
+    }
+}
+
+std::optional<std::string> ObjectReader::NextKey() {
+    StreamReader reader(input_);
+    char c;
+    while (reader.ReadNonSpace(c) && c == ',') {
+    }
+    if (!reader) {
+        throw ParsingError("Dictionary parsing error"s);
+    }
+    if (c == '}') {
+        return std::nullopt;
+    }
+    if (c != '"') {
+        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+    }
+    std::string key = ReadStringBody(std::string{}, reader);
+    if (!reader.ReadNonSpace(c) || c != ':') {
+        throw ParsingError(": is expected after key '"s + key + "'"s);
+    }
+    return key;
+}
+
+Node ObjectReader::ReadValue() {
+    StreamReader reader(input_);
+    return LoadNode(reader, false);
+}
+
+bool ObjectReader::StartArray() {
+    StreamReader reader(input_);
+    char c;
+    if (!reader.ReadNonSpace(c)) {
+        throw ParsingError("Unexpected EOF"s);
+    }
+    if (c != '[') {
+        reader.PutBack(c);
+        return false;
+    }
+    return true;
+}
+
+std::optional<Node> ObjectReader::NextElement() {
+    StreamReader reader(input_);
+    char c;
+    while (reader.ReadNonSpace(c) && c == ',') {
+    }
+    if (!reader) {
+        throw ParsingError("Array parsing error"s);
+    }
+    if (c == ']') {
+        return std::nullopt;
+    }
+    reader.PutBack(c);
+    return LoadNode(reader, false);
+}
+
+ArrayWriter::ArrayWriter(std::ostream& output)
+    : output_(output) {
+    output_ << "[\n"sv;
+}
+
+void ArrayWriter::Write(const Node& node) {
+    if (!is_first_) {
+        output_ << ",\n"sv;
+    }
+    is_first_ = false;
+    const PrintContext context = PrintContext{output_}.Indented();
+    context.PrintIndent();
+    PrintNode(node, context);
+}
+
+void ArrayWriter::Finish() {
+    output_ << "\n]"sv;
+}
+
 }
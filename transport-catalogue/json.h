@@ -1,24 +1,88 @@
 #pragma once
 
+#include <algorithm>
+#include <initializer_list>
 #include <iostream>
-#include <map>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
 using Array = std::vector<Node>;
 
+// Tag for constructing a Dict from items already sorted by key, without repeats.
+struct SortedUnique {};
+inline constexpr SortedUnique sorted_unique{};
+
+// JSON object as a vector of key/value pairs sorted by key. Objects here are small and
+// read far more often than built, so lookups binary-search one contiguous block, and
+// take string_view keys without building a temporary std::string. Iteration is in key
+// order, as with std::map; keys cannot be changed through iterators.
+class Dict {
+public:
+    using key_type = std::string;
+    using mapped_type = Node;
+    using value_type = std::pair<std::string, Node>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+    using iterator = const_iterator;
+
+    Dict() = default;
+    Dict(std::initializer_list<value_type> items);
+    Dict(SortedUnique, std::vector<value_type> items);
+
+    const_iterator begin() const {
+        return items_.begin();
+    }
+    const_iterator end() const {
+        return items_.end();
+    }
+    size_t size() const {
+        return items_.size();
+    }
+    bool empty() const {
+        return items_.empty();
+    }
+
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    // Throws std::out_of_range when there is no such key.
+    const Node& at(std::string_view key) const;
+
+    // Inserts a null value when there is no such key.
+    Node& operator[](std::string key);
+    // Does nothing when the key is already present, as std::map::emplace.
+    std::pair<const_iterator, bool> emplace(std::string key, Node value);
+
+    bool operator==(const Dict& rhs) const;
+
+private:
+    std::vector<value_type> items_;
+
+    std::vector<value_type>::iterator LowerBound(std::string_view key);
+    const_iterator LowerBound(std::string_view key) const;
+};
+
 class ParsingError : public std::runtime_error {
 public:
     using runtime_error::runtime_error;
 };
 
+// String value pointing into the buffer a document was parsed from, see LoadView.
+struct BorrowedString {
+    std::string_view text;
+
+    bool operator==(const BorrowedString& rhs) const {
+        return text == rhs.text;
+    }
+};
+
 class Node final
-    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, BorrowedString> {
 public:
     using variant::variant;
 	using Value = variant;
@@ -79,10 +143,13 @@ public:
     }
 
     bool IsString() const {
-        return std::holds_alternative<std::string>(*this);
+        return std::holds_alternative<std::string>(*this) || std::holds_alternative<BorrowedString>(*this);
     }
-    const std::string& AsString() const {
+    std::string_view AsString() const {
         using namespace std::literals;
+        if (const auto* borrowed = std::get_if<BorrowedString>(this)) {
+            return borrowed->text;
+        }
         if (!IsString()) {
             throw std::logic_error("Not a string"s);
         }
@@ -103,6 +170,9 @@ public:
     }
 
     bool operator==(const Node& rhs) const {
+        if (IsString() && rhs.IsString()) {
+            return AsString() == rhs.AsString();
+        }
         return GetValue() == rhs.GetValue();
     }
 
@@ -118,6 +188,65 @@ inline bool operator!=(const Node& lhs, const Node& rhs) {
     return !(lhs == rhs);
 }
 
+inline Dict::Dict(std::initializer_list<value_type> items) {
+    items_.reserve(items.size());
+    for (const auto& [key, value] : items) {
+        emplace(key, value);
+    }
+}
+
+inline Dict::Dict(SortedUnique, std::vector<value_type> items)
+    : items_(std::move(items)) {
+}
+
+inline std::vector<Dict::value_type>::iterator Dict::LowerBound(std::string_view key) {
+    return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, std::string_view key) {
+        return item.first < key;
+    });
+}
+
+inline Dict::const_iterator Dict::LowerBound(std::string_view key) const {
+    return const_cast<Dict*>(this)->LowerBound(key);
+}
+
+inline Dict::const_iterator Dict::find(std::string_view key) const {
+    const auto iter = LowerBound(key);
+    return iter != items_.end() && iter->first == key ? iter : items_.end();
+}
+
+inline size_t Dict::count(std::string_view key) const {
+    return find(key) != items_.end();
+}
+
+inline const Node& Dict::at(std::string_view key) const {
+    using namespace std::literals;
+    const auto iter = find(key);
+    if (iter == items_.end()) {
+        throw std::out_of_range("No key '"s + std::string{key} + "' in dict"s);
+    }
+    return iter->second;
+}
+
+inline Node& Dict::operator[](std::string key) {
+    auto iter = LowerBound(key);
+    if (iter == items_.end() || iter->first != key) {
+        iter = items_.emplace(iter, std::move(key), Node{});
+    }
+    return iter->second;
+}
+
+inline std::pair<Dict::const_iterator, bool> Dict::emplace(std::string key, Node value) {
+    auto iter = LowerBound(key);
+    if (iter != items_.end() && iter->first == key) {
+        return {iter, false};
+    }
+    return {items_.emplace(iter, std::move(key), std::move(value)), true};
+}
+
+inline bool Dict::operator==(const Dict& rhs) const {
+    return items_ == rhs.items_;
+}
+
 class Document {
 public:
     explicit Document(Node root)
@@ -141,7 +270,51 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
 }
 
 Document Load(std::istream& input);
+// Parses a document held in memory. Strings without escape sequences are not copied
+// but point into text, which must outlive the document and every copy of its nodes.
+Document LoadView(std::string_view text);
+// Same as LoadView, but the arrays directly inside a root object, such as base_requests,
+// are split at element boundaries found by a quick structural scan and parsed on up to
+// thread_count threads. Arrays too small to be worth it are parsed as usual.
+Document LoadViewParallel(std::string_view text, size_t thread_count);
 
 void Print(const Document& doc, std::ostream& output);
 
+// Reads a root object from a stream one member at a time, so that a member can be
+// used before the rest of the input has arrived. Array members can also be read
+// element by element.
+class ObjectReader {
+public:
+    // Reads the opening brace.
+    explicit ObjectReader(std::istream& input);
+
+    // Key of the next member, nothing after the closing brace.
+    std::optional<std::string> NextKey();
+    // Value of the member whose key was just read.
+    Node ReadValue();
+
+    // Starts reading the member's value as an array; false, reading nothing, when it is not one.
+    bool StartArray();
+    // Next element of the array started by StartArray, nothing after its closing bracket.
+    std::optional<Node> NextElement();
+
+private:
+    std::istream& input_;
+};
+
+// Writes an array element by element, in the layout Print gives the whole array.
+class ArrayWriter {
+public:
+    // Writes the opening bracket.
+    explicit ArrayWriter(std::ostream& output);
+
+    void Write(const Node& node);
+    // Writes the closing bracket.
+    void Finish();
+
+private:
+    std::ostream& output_;
+    bool is_first_ = true;
+};
+
 }
\ No newline at end of file
@@ -1,10 +1,32 @@
 #include "json_reader.h"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <limits>
+#include <numeric>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 using namespace std;
 
+json::Document JsonReader::LoadDocument(istream& input) {
+    instrumentation::ScopedTimer timer("json::Load"sv);
+    return json::Load(input);
+}
+
+json::Document JsonReader::LoadDocument(string_view text) {
+    instrumentation::ScopedTimer timer("json::Load"sv);
+    return json::LoadViewParallel(text, max(1u, thread::hardware_concurrency()));
+}
+
+JsonReader JsonReader::FromFile(const string& path) {
+    return JsonReader(make_shared<const mapped_file::MappedFile>(path));
+}
+
 const json::Node& JsonReader::GetBaseRequests() const {
     auto br_iter = input_.GetRoot().AsDict().find("base_requests");
     return br_iter != input_.GetRoot().AsDict().end() ? br_iter -> second : dummy_;
@@ -25,11 +47,40 @@ const json::Node& JsonReader::GetRoutingSettings() const {
     return rs_iter != input_.GetRoot().AsDict().end() ? rs_iter -> second : dummy_;
 }
 
+const json::Node& JsonReader::GetRequestSettings() const {
+    auto rs_iter = input_.GetRoot().AsDict().find("request_settings");
+    return rs_iter != input_.GetRoot().AsDict().end() ? rs_iter -> second : dummy_;
+}
+
+int JsonReader::ParseDefaultTimeout() const {
+    const json::Node& settings = GetRequestSettings();
+    if (!settings.IsDict()) {
+        return 0;
+    }
+    const auto timeout_iter = settings.AsDict().find("timeout_ms"sv);
+    return timeout_iter != settings.AsDict().end() ? timeout_iter->second.AsInt() : 0;
+}
+
 void JsonReader::PopulateCatalogue(transport_catalogue::TransportCatalogue& catalogue) {
+    instrumentation::ScopedTimer timer("PopulateCatalogue"sv);
+    if (input_file_) {
+        catalogue.AttachNameBuffer(input_file_, input_file_->GetData());
+    }
     const json::Array& base_requests_arr = GetBaseRequests().AsArray();
-    PopulateStop(base_requests_arr, catalogue);  
-    PopulateStopDistances(base_requests_arr, catalogue); 
-    PopulateBus(base_requests_arr, catalogue); 
+    {
+        instrumentation::ScopedTimer stops_timer("PopulateCatalogue: stops"sv);
+        PopulateStop(base_requests_arr, catalogue);
+    }
+    {
+        instrumentation::ScopedTimer distances_timer("PopulateCatalogue: distances"sv);
+        PopulateStopDistances(base_requests_arr, catalogue);
+    }
+    {
+        instrumentation::ScopedTimer buses_timer("PopulateCatalogue: buses"sv);
+        PopulateBus(base_requests_arr, catalogue);
+    }
+    instrumentation::ScopedTimer finalize_timer("PopulateCatalogue: finalize"sv);
+    catalogue.Finalize();
 }
 
 pair<string_view, geo::Coordinates> JsonReader::ParseStop(const json::Dict& request_map) const {
@@ -44,55 +95,86 @@ void JsonReader::PopulateStop(const json::Array& base_requests_arr, transport_ca
         const auto& type = request_map.at("type").AsString();
         if (type == "Stop") {
             auto [stop_name, coordinates] = ParseStop(request_map);
-            catalogue.AddStop(string{stop_name}, coordinates);
+            catalogue.AddStop(stop_name, coordinates);
         }
     }
 }
 
 void JsonReader::PopulateStopDistances(const json::Array& base_requests_arr, transport_catalogue::TransportCatalogue& catalogue) const {
-    for (auto& request : base_requests_arr) {
-        const auto& request_map = request.AsDict();
-        const auto& type = request_map.at("type").AsString();
-        if (type == "Stop") {
-            string_view stop_from = request_map.at("name").AsString();
-            auto& distances = request_map.at("road_distances").AsDict();
-            for (auto& [stop_to, dist] : distances) {
-                catalogue.SetDistance(stop_from, stop_to, dist.AsInt());
+    using Distance = tuple<const domain::Stop*, const domain::Stop*, int>;
+    const size_t chunk_count = parallel::GetChunkCount(base_requests_arr.size(), MIN_REQUESTS_PER_THREAD);
+    vector<vector<Distance>> distances_buffers(chunk_count);
+    parallel::ForEachChunk(base_requests_arr.size(), chunk_count, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& request_map = base_requests_arr[i].AsDict();
+            const auto& type = request_map.at("type").AsString();
+            if (type == "Stop") {
+                const domain::Stop* stop_from = ResolveStop(request_map.at("name").AsString(), catalogue);
+                auto& distances = request_map.at("road_distances").AsDict();
+                for (auto& [stop_to, dist] : distances) {
+                    distances_buffers[chunk].emplace_back(stop_from, ResolveStop(stop_to, catalogue), dist.AsInt());
+                }
             }
         }
+    });
+
+    for (const auto& distances : distances_buffers) {
+        for (const auto& [stop_from, stop_to, length] : distances) {
+            catalogue.SetDistance(stop_from, stop_to, length);
+        }
     }
 }
 
+const domain::Stop* JsonReader::ResolveStop(string_view stop_name, const transport_catalogue::TransportCatalogue& catalogue) const {
+    const domain::Stop* stop = catalogue.FindStop(stop_name);
+    if (!stop) {
+        throw std::out_of_range("Unknown stop: "s + string{stop_name});
+    }
+    return stop;
+}
+
 tuple<string_view, vector<string_view>, bool> JsonReader::ParseBus(const json::Dict& request_map) const {
     string_view bus_name = request_map.at("name").AsString();
     vector<string_view> stops;
     bool is_roundtrip = request_map.at("is_roundtrip").AsBool();
     const auto& stops_arr = request_map.at("stops").AsArray();
+    stops.reserve(stops_arr.size());
     for (auto& stop : stops_arr) {
         stops.push_back(stop.AsString());
     }
-    if (!is_roundtrip) {
-        for (int i = stops_arr.size() - 2; i >= 0; --i) {
-            stops.push_back(stops_arr[i].AsString());
-        }
-    }
     return make_tuple(bus_name, stops, is_roundtrip);
 }
 
 void JsonReader::PopulateBus(const json::Array& base_requests_arr, transport_catalogue::TransportCatalogue& catalogue) const {
-    for (auto& request : base_requests_arr) {
-        const auto& request_map = request.AsDict();
-        const auto& type = request_map.at("type").AsString();
-        if (type == "Bus") {
-            auto [bus_name, stops, is_roundtrip] = ParseBus(request_map);
-            catalogue.AddBus(string{bus_name}, stops, is_roundtrip);
+    using ResolvedBus = tuple<string_view, vector<const domain::Stop*>, bool>;
+    const size_t chunk_count = parallel::GetChunkCount(base_requests_arr.size(), MIN_REQUESTS_PER_THREAD);
+    vector<vector<ResolvedBus>> buses_buffers(chunk_count);
+    parallel::ForEachChunk(base_requests_arr.size(), chunk_count, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& request_map = base_requests_arr[i].AsDict();
+            const auto& type = request_map.at("type").AsString();
+            if (type == "Bus") {
+                auto [bus_name, stops, is_roundtrip] = ParseBus(request_map);
+                vector<const domain::Stop*> bus_stops;
+                bus_stops.reserve(stops.size());
+                for (const string_view stop : stops) {
+                    bus_stops.push_back(ResolveStop(stop, catalogue));
+                }
+                buses_buffers[chunk].emplace_back(bus_name, move(bus_stops), is_roundtrip);
+            }
+        }
+    });
+
+    for (auto& buses : buses_buffers) {
+        for (auto& [bus_name, stops, is_roundtrip] : buses) {
+            catalogue.AddBus(bus_name, move(stops), is_roundtrip);
         }
     }
 }
 
 variant<monostate, string, svg::Rgb, svg::Rgba> JsonReader::ParseColor(const json::Node& color_node) const {
     if (color_node.IsString()) {
-        return color_node.AsString();
+        return string{color_node.AsString()};
     } else if (color_node.IsArray()) {
         const auto& color_array = color_node.AsArray();
         if (color_array.size() == 3) {
@@ -140,46 +222,289 @@ map_renderer::MapRenderer JsonReader::FillRenderSettings(const json::Dict& reque
     return render_settings;
 }
 
+map_renderer::MapRenderer JsonReader::MakeRenderer() const {
+    const json::Node& settings = GetRenderSettings();
+    return settings.IsDict() ? FillRenderSettings(settings.AsDict()) : map_renderer::MapRenderer{map_renderer::RenderSettings{}};
+}
+
+transport_router::RoutingSettings JsonReader::MakeRoutingSettings() const {
+    const json::Node& settings = GetRoutingSettings();
+    return settings.IsDict() ? ParseRoutingSettings(settings.AsDict()) : transport_router::RoutingSettings{};
+}
+
+transport_router::RoutingSettings JsonReader::ParseRoutingSettings(const json::Dict& request_map) const {
+    transport_router::RoutingSettings routing_settings;
+    routing_settings.bus_wait_time = request_map.at("bus_wait_time"sv).AsInt();
+    routing_settings.bus_velocity = request_map.at("bus_velocity"sv).AsDouble();
+    if (const auto cache_iter = request_map.find("route_cache_size"sv); cache_iter != request_map.end()) {
+        const int route_cache_size = cache_iter->second.AsInt();
+        if (route_cache_size < 0) {
+            throw invalid_argument("Invalid route_cache_size: expected a non-negative number"s);
+        }
+        routing_settings.route_cache_capacity = static_cast<size_t>(route_cache_size);
+    }
+    return routing_settings;
+}
+
 transport_router::TransportRouter JsonReader::FillRoutingSettings(
     const json::Dict& request_map
     , const transport_catalogue::TransportCatalogue& catalogue
     ) const {
-    transport_router::RoutingSettings routing_settings;
-    routing_settings.bus_wait_time = request_map.at("bus_wait_time"s).AsInt();
-    routing_settings.bus_velocity = request_map.at("bus_velocity"s).AsDouble();
-    return {routing_settings, catalogue};
+    return {ParseRoutingSettings(request_map), catalogue};
+}
+
+StatRequestCounts JsonReader::CountStatRequests(const json::Node& stat_requests) const {
+    StatRequestCounts counts;
+    if (!stat_requests.IsArray()) {
+        return counts;
+    }
+    for (const auto& request : stat_requests.AsArray()) {
+        const auto& type = request.AsDict().at("type"sv).AsString();
+        if (type == "Bus"sv) {
+            ++counts.bus_count;
+        } else if (type == "Stop"sv) {
+            ++counts.stop_count;
+        } else if (type == "Map"sv) {
+            ++counts.map_count;
+        } else if (type == "Route"sv) {
+            ++counts.route_count;
+        } else if (type == "StopSearch"sv) {
+            ++counts.stop_search_count;
+        }
+    }
+    return counts;
+}
+
+string_view GetStatRequestTypeName(StatRequestType type) {
+    switch (type) {
+        case StatRequestType::BUS:
+            return "Bus"sv;
+        case StatRequestType::STOP:
+            return "Stop"sv;
+        case StatRequestType::MAP:
+            return "Map"sv;
+        case StatRequestType::ROUTE:
+            return "Route"sv;
+        case StatRequestType::STOP_SEARCH:
+            return "StopSearch"sv;
+    }
+    return {};
 }
 
 void JsonReader::ProcessStatRequests(const json::Node& stat_requests, const RequestHandler& handler) const {
+    instrumentation::ScopedTimer timer("ProcessStatRequests"sv);
+    vector<StatRequest> requests;
+    {
+        instrumentation::ScopedTimer decode_timer("Decode stat requests"sv);
+        requests = DecodeStatRequests(stat_requests, handler);
+    }
+    StatRequestPlan plan;
+    {
+        instrumentation::ScopedTimer plan_timer("Plan stat requests"sv);
+        plan = PlanStatRequests(requests);
+    }
     json::Array result;
-    for (auto& request : stat_requests.AsArray()) {
-        const auto& request_map = request.AsDict();
-        const auto& type = request_map.at("type").AsString();
-        if (type == "Bus") {
-            result.push_back(PrintBus(request_map, handler).AsDict());
-        }        
-        if (type == "Stop") {
-            result.push_back(PrintStop(request_map, handler).AsDict());
+    {
+        instrumentation::ScopedTimer execute_timer("Execute stat requests"sv);
+        result = ExecuteStatRequests(requests, plan, handler);
+    }
+    instrumentation::ScopedTimer print_timer("json::Print"sv);
+    json::Print(json::Document{result}, cout);
+}
+
+optional<json::Node> JsonReader::ProcessStatRequest(const json::Dict& request_map, const RequestHandler& handler) const {
+    const optional<StatRequest> request = DecodeStatRequest(request_map, handler);
+    if (!request) {
+        return nullopt;
+    }
+    return ExecuteStatRequest(*request, handler);
+}
+
+vector<StatRequest> JsonReader::DecodeStatRequests(const json::Node& stat_requests, const RequestHandler& handler) const {
+    vector<StatRequest> requests;
+    requests.reserve(stat_requests.AsArray().size());
+    for (const auto& request : stat_requests.AsArray()) {
+        if (auto decoded = DecodeStatRequest(request.AsDict(), handler)) {
+            requests.push_back(*decoded);
+        }
+    }
+    return requests;
+}
+
+optional<StatRequest> JsonReader::DecodeStatRequest(const json::Dict& request_map, const RequestHandler& handler) const {
+    StatRequest request;
+    const string_view type = request_map.at("type"sv).AsString();
+    if (type == "Bus"sv) {
+        request.type = StatRequestType::BUS;
+        request.bus = handler.FindBus(request_map.at("name"sv).AsString());
+    } else if (type == "Stop"sv) {
+        request.type = StatRequestType::STOP;
+        request.stop = handler.FindStop(request_map.at("name"sv).AsString());
+    } else if (type == "Map"sv) {
+        request.type = StatRequestType::MAP;
+    } else if (type == "Route"sv) {
+        request.type = StatRequestType::ROUTE;
+        request.stop = handler.FindStop(request_map.at("from"sv).AsString());
+        request.stop_to = handler.FindStop(request_map.at("to"sv).AsString());
+        if (const auto pareto_iter = request_map.find("pareto"sv);
+            pareto_iter != request_map.end() && pareto_iter->second.AsBool()) {
+            request.route_mode = StatRequest::RouteMode::PARETO;
+        } else if (const auto alternatives_iter = request_map.find("alternatives"sv); alternatives_iter != request_map.end()) {
+            const int max_count = alternatives_iter->second.AsInt();
+            if (max_count < 1) {
+                throw std::logic_error("Invalid alternatives count: expected a positive number");
+            }
+            request.route_mode = StatRequest::RouteMode::ALTERNATIVES;
+            request.max_count = static_cast<size_t>(max_count);
+        }
+    } else if (type == "StopSearch"sv) {
+        request.type = StatRequestType::STOP_SEARCH;
+        request.query = request_map.at("prefix"sv).AsString();
+        const auto max_count_iter = request_map.find("max_count"sv);
+        const int max_count = max_count_iter != request_map.end() ? max_count_iter->second.AsInt() : DEFAULT_SEARCH_COUNT;
+        if (max_count < 1) {
+            throw std::logic_error("Invalid max_count: expected a positive number");
+        }
+        request.max_count = static_cast<size_t>(max_count);
+        if (const auto max_edits_iter = request_map.find("max_edits"sv); max_edits_iter != request_map.end()) {
+            request.max_edits = max_edits_iter->second.AsInt();
+            if (request.max_edits < 0 || request.max_edits > name_search::NameSearchIndex::MAX_EDITS) {
+                throw std::logic_error("Invalid max_edits: expected a number from 0 to "s
+                                       + to_string(name_search::NameSearchIndex::MAX_EDITS));
+            }
         }
-        if (type == "Map") {
-            result.push_back(PrintMap(request_map, handler).AsDict());
+    } else {
+        return nullopt;
+    }
+    request.id = request_map.at("id"sv).AsInt();
+    const auto timeout_iter = request_map.find("timeout_ms"sv);
+    request.timeout_ms = timeout_iter != request_map.end() ? timeout_iter->second.AsInt() : default_timeout_ms_;
+    return request;
+}
+
+StatRequestPlan PlanStatRequests(const vector<StatRequest>& requests) {
+    static constexpr size_t NONE = numeric_limits<size_t>::max();
+    const auto get_key = [&requests](size_t index) {
+        const StatRequest& request = requests[index];
+        return tuple{
+            request.type,
+            request.stop ? request.stop->id : NONE,
+            request.stop_to ? request.stop_to->id : NONE,
+            request.bus ? request.bus->id : NONE,
+            request.route_mode,
+            request.max_count,
+            string_view{request.query},
+            request.max_edits,
+            request.timeout_ms,
+        };
+    };
+
+    // Sorting by type and origin first puts identical requests next to each other
+    // and Route requests of one origin together; ties keep the batch order.
+    vector<size_t> order(requests.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&get_key](size_t lhs, size_t rhs) {
+        return get_key(lhs) < get_key(rhs);
+    });
+
+    StatRequestPlan plan;
+    plan.answer_sources.resize(requests.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || get_key(order[i]) != get_key(order[i - 1])) {
+            plan.execution_order.push_back(order[i]);
         }
-        if (type == "Route") {
-            result.push_back(PrintBestRoute(request_map, handler).AsDict());
+        plan.answer_sources[order[i]] = plan.execution_order.back();
+    }
+    return plan;
+}
+
+StatRequestCost EstimateStatRequestCost(const StatRequest& request) {
+    switch (request.type) {
+        case StatRequestType::MAP:
+            return StatRequestCost::EXPENSIVE;
+        case StatRequestType::ROUTE:
+            return request.route_mode == StatRequest::RouteMode::BEST ? StatRequestCost::CHEAP : StatRequestCost::EXPENSIVE;
+        default:
+            return StatRequestCost::CHEAP;
+    }
+}
+
+json::Array JsonReader::ExecuteStatRequests(
+    const vector<StatRequest>& requests, const StatRequestPlan& plan, const RequestHandler& handler) const {
+    vector<size_t> cheap_requests;
+    vector<size_t> expensive_requests;
+    cheap_requests.reserve(plan.execution_order.size());
+    for (const size_t index : plan.execution_order) {
+        (EstimateStatRequestCost(requests[index]) == StatRequestCost::CHEAP ? cheap_requests : expensive_requests)
+            .push_back(index);
+    }
+
+    // Every response slot is written by exactly one of the two threads.
+    json::Array responses(requests.size());
+    const auto execute = [&](const vector<size_t>& indices) {
+        for (const size_t index : indices) {
+            responses[index] = ExecuteStatRequest(requests[index], handler);
         }
+    };
+    future<void> expensive_worker;
+    if (!expensive_requests.empty()) {
+        expensive_worker = async(launch::async, execute, cref(expensive_requests));
     }
-    json::Print(json::Document{result}, cout);
+    execute(cheap_requests);
+    if (expensive_worker.valid()) {
+        expensive_worker.get();
+    }
+    for (size_t index = 0; index < requests.size(); ++index) {
+        const size_t source = plan.answer_sources[index];
+        if (source != index) {
+            responses[index] = responses[source];
+            get<json::Dict>(responses[index].GetValue())["request_id"s] = requests[index].id;
+        }
+    }
+    return responses;
+}
+
+json::Node JsonReader::ExecuteStatRequest(const StatRequest& request, const RequestHandler& handler) const {
+    instrumentation::ScopedTimer request_timer(GetStatRequestTypeName(request.type), instrumentation::EventKind::REQUEST);
+    const cancellation::Deadline deadline = request.timeout_ms > 0
+        ? cancellation::Deadline(chrono::milliseconds(request.timeout_ms))
+        : cancellation::Deadline{};
+    return ExecuteStatRequest(request, handler, deadline);
+}
+
+json::Node JsonReader::ExecuteStatRequest(const StatRequest& request, const RequestHandler& handler,
+                                          const cancellation::Deadline& deadline) const {
+    try {
+        switch (request.type) {
+            case StatRequestType::BUS:
+                return PrintBus(request, handler);
+            case StatRequestType::STOP:
+                return PrintStop(request, handler);
+            case StatRequestType::MAP:
+                return PrintMap(request, handler, deadline);
+            case StatRequestType::ROUTE:
+                return PrintBestRoute(request, handler, deadline);
+            case StatRequestType::STOP_SEARCH:
+                return PrintStopSearch(request, handler);
+        }
+    } catch (const cancellation::DeadlineExceeded&) {
+        return PrintTimeoutError(request.id);
+    }
+    return PrintNotFoundError(request.id);
+}
+
+void JsonReader::ReleaseInput() {
+    input_ = json::Document{dummy_};
 }
 
-const json::Node JsonReader::PrintBus(const json::Dict& request_map, const RequestHandler& handler) const {
+const json::Node JsonReader::PrintBus(const StatRequest& request, const RequestHandler& handler) const {
     json::Node result;
-    const int request_id = request_map.at("id").AsInt();
-    const string& bus_name = request_map.at("name").AsString();
-    if (!handler.IsBusExists(bus_name)) {
+    const int request_id = request.id;
+    if (!request.bus) {
         result = PrintNotFoundError(request_id);
     }
     else {
-        const domain::RouteInfo route = handler.GetRouteInfo(bus_name);
+        const domain::RouteInfo route = handler.GetRouteInfo(request.bus);
         result = json::Builder{}
                         .StartDict()
                             .Key("request_id").Value(request_id)
@@ -193,16 +518,15 @@ const json::Node JsonReader::PrintBus(const json::Dict& request_map, const Reque
     return result;
 }
 
-const json::Node JsonReader::PrintStop(const json::Dict& request_map, const RequestHandler& handler) const {
+const json::Node JsonReader::PrintStop(const StatRequest& request, const RequestHandler& handler) const {
     json::Node result;
-    const int request_id = request_map.at("id").AsInt();
-    const string& stop_name = request_map.at("name").AsString();
-    if (!handler.IsStopExists(stop_name)) {
+    const int request_id = request.id;
+    if (!request.stop) {
         result = PrintNotFoundError(request_id);
     }
     else {
         json::Array buses;
-        for (const string_view bus : handler.GetBuses(stop_name)) {
+        for (const string_view bus : handler.GetBuses(request.stop)) {
             buses.push_back(string{bus});
         }
         result = json::Builder{}
@@ -215,12 +539,27 @@ const json::Node JsonReader::PrintStop(const json::Dict& request_map, const Requ
     return result;
 }
 
-const json::Node JsonReader::PrintMap(const json::Dict& request_map, const RequestHandler& handler) const {
+const json::Node JsonReader::PrintStopSearch(const StatRequest& request, const RequestHandler& handler) const {
+    json::Array stops;
+    for (const name_search::Match& match : handler.SearchStops(request.query, request.max_edits, request.max_count)) {
+        stops.push_back(string{match.name});
+    }
+    return json::Builder{}
+                .StartDict()
+                    .Key("request_id").Value(request.id)
+                    .Key("stops").Value(stops)
+                .EndDict()
+            .Build();
+}
+
+const json::Node JsonReader::PrintMap(const StatRequest& request, const RequestHandler& handler,
+                                      const cancellation::Deadline& deadline) const {
     json::Node result;
-    const int request_id = request_map.at("id").AsInt();
+    const int request_id = request.id;
     ostringstream strm;
-    svg::Document svg_map = handler.RenderMap();
+    svg::Document svg_map = handler.RenderMap(deadline);
     svg_map.Render(strm);
+    deadline.ThrowIfExpired();
     result = json::Builder{}
                     .StartDict()
                         .Key("request_id").Value(request_id)
@@ -230,7 +569,7 @@ const json::Node JsonReader::PrintMap(const json::Dict& request_map, const Reque
     return result;
 }
 
-const json::Node JsonReader::PrintNotFoundError(const int request_id) const {
+const json::Node JsonReader::PrintNotFoundError(const int request_id) {
     return json::Builder{}
                     .StartDict()
                         .Key("request_id").Value(request_id)
@@ -239,55 +578,107 @@ const json::Node JsonReader::PrintNotFoundError(const int request_id) const {
                 .Build();
 }
 
-const json::Node JsonReader::PrintBestRoute(const json::Dict& request_map, const RequestHandler& handler) const {
-    json::Node result;
-    const int request_id = request_map.at("id"s).AsInt();
-    const string_view stop_from = request_map.at("from"s).AsString();
-    const string_view stop_to = request_map.at("to"s).AsString();
-    const auto& route = handler.GetBestRoute(stop_from, stop_to);
-    
-    if (!route) {
-        result = PrintNotFoundError(request_id);
-    }
-    else {
-        json::Array items;
-        double total_time = 0.0;
-        items.reserve(route.value().size());
-        for (const graph::Edge<double>* edge : route.value()) {
-            if (edge->quality == 0) {
-                items.emplace_back(json::Node(json::Builder{}
+const json::Node JsonReader::PrintTimeoutError(const int request_id) {
+    return json::Builder{}
                     .StartDict()
-                        .Key("stop_name"s).Value(edge->name)
-                        .Key("time"s).Value(edge->weight)
-                        .Key("type"s).Value("Wait"s)
+                        .Key("request_id").Value(request_id)
+                        .Key("error_message").Value("timeout")
                     .EndDict()
-                .Build()));
-
-                total_time += edge->weight;
-            }
+                .Build();
+}
 
-            else {
-                items.emplace_back(json::Node(json::Builder{}
+const json::Node JsonReader::PrintMissingSettingsError(const int request_id, string_view section) {
+    return json::Builder{}
                     .StartDict()
-                        .Key("bus"s).Value(edge->name)
-                        .Key("span_count"s).Value(static_cast<int>(edge->quality))
-                        .Key("time"s).Value(edge->weight)
-                        .Key("type"s).Value("Bus"s)
+                        .Key("request_id").Value(request_id)
+                        .Key("error_message").Value("no "s + string{section})
                     .EndDict()
-                .Build()));
+                .Build();
+}
 
-                total_time += edge->weight;
-            }
-        }
+const json::Node JsonReader::PrintBestRoute(const StatRequest& request, const RequestHandler& handler,
+                                            const cancellation::Deadline& deadline) const {
+    const int request_id = request.id;
+    if (!request.stop || !request.stop_to) {
+        return PrintNotFoundError(request_id);
+    }
+    if (request.route_mode == StatRequest::RouteMode::PARETO) {
+        return PrintRoutes(request_id, handler.GetParetoRoutes(request.stop, request.stop_to, deadline));
+    }
+    if (request.route_mode == StatRequest::RouteMode::ALTERNATIVES) {
+        return PrintRoutes(request_id, handler.GetAlternativeRoutes(request.stop, request.stop_to, request.max_count, deadline));
+    }
 
-        result = json::Builder{}
+    const auto& route = handler.GetBestRoute(request.stop, request.stop_to);
+    if (!route) {
+        return PrintNotFoundError(request_id);
+    }
+    return json::Builder{}
+        .StartDict()
+            .Key("request_id"s).Value(request_id)
+            .Key("total_time"s).Value(ComputeTotalTime(route.value()))
+            .Key("items"s).Value(PrintRouteItems(route.value()))
+        .EndDict()
+    .Build();
+}
+
+const json::Node JsonReader::PrintRoutes(const int request_id, const vector<transport_router::Route>& routes) const {
+    if (routes.empty()) {
+        return PrintNotFoundError(request_id);
+    }
+    json::Array routes_array;
+    routes_array.reserve(routes.size());
+    for (const auto& route : routes) {
+        const auto waits = count_if(route.begin(), route.end(),
+                                    [](const graph::Edge<double>* edge) { return edge->quality == 0; });
+        routes_array.emplace_back(json::Builder{}
             .StartDict()
-                .Key("request_id"s).Value(request_id)
-                .Key("total_time"s).Value(total_time)
-                .Key("items"s).Value(items)
+                .Key("total_time"s).Value(ComputeTotalTime(route))
+                .Key("transfer_count"s).Value(static_cast<int>(max<ptrdiff_t>(waits - 1, 0)))
+                .Key("items"s).Value(PrintRouteItems(route))
             .EndDict()
-        .Build();
+        .Build());
     }
+    return json::Builder{}
+        .StartDict()
+            .Key("request_id"s).Value(request_id)
+            .Key("routes"s).Value(routes_array)
+        .EndDict()
+    .Build();
+}
 
-    return result;
-}
\ No newline at end of file
+json::Array JsonReader::PrintRouteItems(const transport_router::Route& route) const {
+    json::Array items;
+    items.reserve(route.size());
+    for (const graph::Edge<double>* edge : route) {
+        if (edge->quality == 0) {
+            items.emplace_back(json::Node(json::Builder{}
+                .StartDict()
+                    .Key("stop_name"s).Value(string{edge->name})
+                    .Key("time"s).Value(edge->weight)
+                    .Key("type"s).Value("Wait"s)
+                .EndDict()
+            .Build()));
+        }
+
+        else {
+            items.emplace_back(json::Node(json::Builder{}
+                .StartDict()
+                    .Key("bus"s).Value(string{edge->name})
+                    .Key("span_count"s).Value(static_cast<int>(edge->quality))
+                    .Key("time"s).Value(edge->weight)
+                    .Key("type"s).Value("Bus"s)
+                .EndDict()
+            .Build()));
+        }
+    }
+    return items;
+}
+
+double JsonReader::ComputeTotalTime(const transport_router::Route& route) const {
+    double total_time = 0.0;
+    for (const graph::Edge<double>* edge : route) {
+        total_time += edge->weight;
+    }
+    return total_time;
+}
@@ -1,50 +1,191 @@
 #pragma once
 
+#include "cancellation.h"
+#include "instrumentation.h"
 #include "json_builder.h"
 #include "map_renderer.h"
+#include "mapped_file.h"
+#include "parallel.h"
 #include "request_handler.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Number of stat requests of each type, known before any of them is answered.
+struct StatRequestCounts {
+    size_t bus_count = 0;
+    size_t stop_count = 0;
+    size_t map_count = 0;
+    size_t route_count = 0;
+    size_t stop_search_count = 0;
+};
+
+enum class StatRequestType {
+    BUS,
+    STOP,
+    MAP,
+    ROUTE,
+    STOP_SEARCH,
+};
+
+std::string_view GetStatRequestTypeName(StatRequestType type);
+
+// A stat request decoded from JSON with its names resolved against the catalogue,
+// so that answering it does no string work. Bus and stop pointers are null when
+// the request names a bus or stop the catalogue does not have.
+struct StatRequest {
+    enum class RouteMode {
+        BEST,
+        PARETO,
+        ALTERNATIVES,
+    };
+
+    StatRequestType type = StatRequestType::MAP;
+    int id = 0;
+    const domain::Bus* bus = nullptr;
+    // The stop of a Stop request, the origin of a Route request.
+    const domain::Stop* stop = nullptr;
+    const domain::Stop* stop_to = nullptr;
+    RouteMode route_mode = RouteMode::BEST;
+    // Itineraries of an alternatives Route request, matches of a StopSearch request.
+    size_t max_count = 0;
+    // The typed name of a StopSearch request and the edits allowed in it.
+    std::string query;
+    int max_edits = 0;
+    // Time budget in milliseconds, 0 for none. Map and multi-itinerary Route requests
+    // that exceed it are answered with the "timeout" error.
+    int timeout_ms = 0;
+};
+
+// How to answer a batch of decoded requests. Requests that differ only in id are
+// answered once, and the answer is copied to the others; Route requests from the
+// same origin are answered one after another, reading one row of the router's table.
+struct StatRequestPlan {
+    // Indices of the requests to answer, in the order to answer them.
+    std::vector<size_t> execution_order;
+    // For every request, the index of the identical request whose answer it gets.
+    std::vector<size_t> answer_sources;
+};
+
+StatRequestPlan PlanStatRequests(const std::vector<StatRequest>& requests);
+
+// A Map request, or a Route request for several itineraries, can cost as much as
+// thousands of Bus and Stop lookups or best-route reads of the precomputed router.
+enum class StatRequestCost {
+    CHEAP,
+    EXPENSIVE,
+};
+
+StatRequestCost EstimateStatRequestCost(const StatRequest& request);
 
 class JsonReader {
 public:
     JsonReader(std::istream& input)
-        : input_(json::Load(input))
+        : input_(LoadDocument(input))
+        , default_timeout_ms_(ParseDefaultTimeout())
+    {}
+
+    // Reader of an already parsed input document.
+    explicit JsonReader(json::Document document)
+        : input_(std::move(document))
+        , default_timeout_ms_(ParseDefaultTimeout())
     {}
 
+    // Parses the memory-mapped file in place; stop and bus names without escapes
+    // stay views into the mapping, which lives as long as the reader or the catalogue.
+    static JsonReader FromFile(const std::string& path);
+
     const json::Node& GetBaseRequests() const;
     const json::Node& GetStatRequests() const;
     const json::Node& GetRenderSettings() const;
     const json::Node& GetRoutingSettings() const;
+    const json::Node& GetRequestSettings() const;
 
     void PopulateCatalogue(transport_catalogue::TransportCatalogue& catalogue);
+    StatRequestCounts CountStatRequests(const json::Node& stat_requests) const;
+
     map_renderer::MapRenderer FillRenderSettings(const json::Dict& request_map) const;
+    // Renderer and routing settings of the input, defaults when the section is absent.
+    map_renderer::MapRenderer MakeRenderer() const;
+    transport_router::RoutingSettings MakeRoutingSettings() const;
+    transport_router::RoutingSettings ParseRoutingSettings(const json::Dict& request_map) const;
     transport_router::TransportRouter FillRoutingSettings(
         const json::Dict& request_map
         , const transport_catalogue::TransportCatalogue& catalogue
         ) const;
 
+    // Decodes every stat request, then answers them in order and prints the responses.
     void ProcessStatRequests(const json::Node& stat_requests, const RequestHandler& handler) const;
-    const json::Node PrintBus(const json::Dict& request_map, const RequestHandler& handler) const;
-    const json::Node PrintStop(const json::Dict& request_map, const RequestHandler& handler) const;
-    const json::Node PrintMap(const json::Dict& request_map, const RequestHandler& handler) const;
-    const json::Node PrintBestRoute(const json::Dict& request_map, const RequestHandler& handler) const;
+    // Response to one stat request; nothing for request types the reader does not know.
+    std::optional<json::Node> ProcessStatRequest(const json::Dict& request_map, const RequestHandler& handler) const;
+
+    // Requests of types the reader does not know are left out.
+    std::vector<StatRequest> DecodeStatRequests(const json::Node& stat_requests, const RequestHandler& handler) const;
+    std::optional<StatRequest> DecodeStatRequest(const json::Dict& request_map, const RequestHandler& handler) const;
+    json::Node ExecuteStatRequest(const StatRequest& request, const RequestHandler& handler) const;
+    // Same against deadline instead of one started from the request's own timeout_ms.
+    json::Node ExecuteStatRequest(const StatRequest& request, const RequestHandler& handler,
+                                  const cancellation::Deadline& deadline) const;
+    // Responses to all requests, in their order. Expensive requests are answered on a
+    // separate thread, so that cheap ones planned after them do not wait for them.
+    json::Array ExecuteStatRequests(
+        const std::vector<StatRequest>& requests, const StatRequestPlan& plan, const RequestHandler& handler) const;
+
+    const json::Node PrintBus(const StatRequest& request, const RequestHandler& handler) const;
+    const json::Node PrintStop(const StatRequest& request, const RequestHandler& handler) const;
+    const json::Node PrintStopSearch(const StatRequest& request, const RequestHandler& handler) const;
+    // Both throw cancellation::DeadlineExceeded when deadline expires before the answer is ready.
+    const json::Node PrintMap(const StatRequest& request, const RequestHandler& handler,
+                              const cancellation::Deadline& deadline = {}) const;
+    const json::Node PrintBestRoute(const StatRequest& request, const RequestHandler& handler,
+                                    const cancellation::Deadline& deadline = {}) const;
+    static const json::Node PrintNotFoundError(const int request_id);
+    static const json::Node PrintTimeoutError(const int request_id);
+    // Response to a request the input has no settings section for, e.g. "no render_settings".
+    static const json::Node PrintMissingSettingsError(const int request_id, std::string_view section);
+
+    // Frees the parsed input once the catalogue and settings are loaded; the Get*
+    // accessors must not be used afterwards. Names borrowed by the catalogue stay valid.
+    void ReleaseInput();
 
 private:
+    static constexpr size_t MIN_REQUESTS_PER_THREAD = 256;
+    static constexpr int DEFAULT_SEARCH_COUNT = 10;
+
+    std::shared_ptr<const mapped_file::MappedFile> input_file_;
     json::Document input_;
     json::Node dummy_ = nullptr;
+    // Budget of stat requests without their own "timeout_ms", from request_settings.
+    int default_timeout_ms_ = 0;
+
+    explicit JsonReader(std::shared_ptr<const mapped_file::MappedFile> input_file)
+        : input_file_(std::move(input_file))
+        , input_(LoadDocument(input_file_->GetData()))
+        , default_timeout_ms_(ParseDefaultTimeout())
+    {}
+
+    static json::Document LoadDocument(std::istream& input);
+    static json::Document LoadDocument(std::string_view text);
+    int ParseDefaultTimeout() const;
 
     std::pair<std::string_view, geo::Coordinates> ParseStop(const json::Dict& request_map) const;
     void PopulateStop(const json::Array& base_requests_arr, transport_catalogue::TransportCatalogue& catalogue) const;
 
     void PopulateStopDistances(const json::Array& base_requests_arr, transport_catalogue::TransportCatalogue& catalogue) const;
+    const domain::Stop* ResolveStop(std::string_view stop_name, const transport_catalogue::TransportCatalogue& catalogue) const;
 
     std::tuple<std::string_view, std::vector<std::string_view>, bool> ParseBus(const json::Dict& request_map) const;
     void PopulateBus(const json::Array& base_requests_arr, transport_catalogue::TransportCatalogue& catalogue) const;
 
     std::variant<std::monostate, std::string, svg::Rgb, svg::Rgba> ParseColor(const json::Node& color_node) const;
 
-    const json::Node PrintNotFoundError(const int request_id) const;
+    const json::Node PrintRoutes(const int request_id, const std::vector<transport_router::Route>& routes) const;
+    json::Array PrintRouteItems(const transport_router::Route& route) const;
+    double ComputeTotalTime(const transport_router::Route& route) const;
 };
\ No newline at end of file
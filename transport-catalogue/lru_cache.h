@@ -0,0 +1,101 @@
+#pragma once
+
+#include "memory_usage.h"
+
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Bounded least-recently-used cache, safe to share between threads.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    std::optional<Value> Find(const Key& key);
+    void Insert(const Key& key, Value value);
+    void Clear();
+
+    CacheStats GetStats() const;
+    // Entry and index bookkeeping; heap memory owned by the cached values is not counted.
+    size_t GetMemoryUsage() const;
+
+private:
+    using Entry = std::pair<Key, Value>;
+    using EntryList = std::list<Entry>;
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    EntryList entries_;
+    std::unordered_map<Key, typename EntryList::iterator, Hash> index_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+template <typename Key, typename Value, typename Hash>
+std::optional<Value> LruCache<Key, Value, Hash>::Find(const Key& key) {
+    std::lock_guard guard(mutex_);
+    const auto iter = index_.find(key);
+    if (iter == index_.end()) {
+        ++misses_;
+        return std::nullopt;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return iter->second->second;
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Insert(const Key& key, Value value) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard guard(mutex_);
+    if (const auto iter = index_.find(key); iter != index_.end()) {
+        iter->second->second = std::move(value);
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        return;
+    }
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.emplace_front(key, std::move(value));
+    index_[key] = entries_.begin();
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Clear() {
+    std::lock_guard guard(mutex_);
+    entries_.clear();
+    index_.clear();
+}
+
+template <typename Key, typename Value, typename Hash>
+CacheStats LruCache<Key, Value, Hash>::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return {hits_, misses_, entries_.size(), capacity_};
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetMemoryUsage() const {
+    std::lock_guard guard(mutex_);
+    return memory_usage::ListBytes(entries_) + memory_usage::UnorderedMapBytes(index_);
+}
+
+}
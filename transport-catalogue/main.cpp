@@ -1,18 +1,161 @@
+#include "city_registry.h"
+#include "instrumentation.h"
 #include "json_reader.h"
+#include "memory_usage.h"
+#include "pipeline.h"
 #include "request_handler.h"
 
-int main() {
-    transport_catalogue::TransportCatalogue catalogue;
-    JsonReader requests(std::cin);
-    requests.PopulateCatalogue(catalogue);
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 
-    const auto& stat_requests = requests.GetStatRequests();
-    const auto& render_settings = requests.GetRenderSettings().AsDict();
-    const auto& renderer = requests.FillRenderSettings(render_settings);
-    const auto& routing_settings = requests.GetRoutingSettings().AsDict();
-    const auto& transport_router = requests.FillRoutingSettings(routing_settings, catalogue);
+using namespace std::literals;
 
-    RequestHandler handler(renderer, catalogue, transport_router);
+namespace {
 
-    requests.ProcessStatRequests(stat_requests, handler);
-}
\ No newline at end of file
+enum class ReportFormat {
+    TEXT,
+    JSON,
+};
+
+struct Options {
+    std::optional<ReportFormat> profile;
+    std::optional<std::string> trace_path;
+    std::optional<std::string> input_path;
+    std::optional<std::string> regions_path;
+    bool print_memory = false;
+    bool pipeline = false;
+};
+
+// --profile[=text|json] prints a timing report to stderr, --trace=FILE writes Chrome trace events,
+// --memory prints the footprint of the loaded catalogue and router to stderr,
+// --input=FILE memory-maps the input instead of reading standard input,
+// --regions=MANIFEST answers region-tagged stat requests from the registry the manifest describes,
+// --pipeline answers stat requests from standard input while they are still arriving.
+Options ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view option = argv[i];
+        if (option == "--profile"sv || option == "--profile=text"sv) {
+            options.profile = ReportFormat::TEXT;
+        } else if (option == "--profile=json"sv) {
+            options.profile = ReportFormat::JSON;
+        } else if (option.substr(0, "--trace="sv.size()) == "--trace="sv) {
+            options.trace_path = std::string{option.substr("--trace="sv.size())};
+        } else if (option.substr(0, "--input="sv.size()) == "--input="sv) {
+            options.input_path = std::string{option.substr("--input="sv.size())};
+        } else if (option.substr(0, "--regions="sv.size()) == "--regions="sv) {
+            options.regions_path = std::string{option.substr("--regions="sv.size())};
+        } else if (option == "--memory"sv) {
+            options.print_memory = true;
+        } else if (option == "--pipeline"sv) {
+            options.pipeline = true;
+        } else {
+            throw std::invalid_argument("Unknown option "s + std::string{option});
+        }
+    }
+    if (options.pipeline && (options.input_path || options.regions_path)) {
+        throw std::invalid_argument("--pipeline reads standard input and cannot be combined with --input or --regions"s);
+    }
+    return options;
+}
+
+// Standard input holds only stat_requests, each with a "region" naming an input file of the manifest.
+void ProcessRegionalRequests(const std::string& manifest_path) {
+    const auto registry = city_registry::LoadManifest(manifest_path);
+    const JsonReader requests(std::cin);
+    json::Array responses;
+    for (const auto& request : requests.GetStatRequests().AsArray()) {
+        if (auto response = registry->ProcessStatRequest(request.AsDict())) {
+            responses.push_back(std::move(*response));
+        }
+    }
+    json::Print(json::Document{std::move(responses)}, std::cout);
+}
+
+void WriteReports(const Options& options) {
+    const auto& profiler = instrumentation::Profiler::Instance();
+    if (options.profile == ReportFormat::TEXT) {
+        profiler.PrintTextReport(std::cerr);
+    } else if (options.profile == ReportFormat::JSON) {
+        profiler.PrintJsonReport(std::cerr);
+    }
+    if (options.trace_path) {
+        std::ofstream trace(*options.trace_path);
+        if (!trace) {
+            throw std::runtime_error("Cannot open "s + *options.trace_path);
+        }
+        profiler.PrintTrace(trace);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nUsage: transport_catalogue [--profile[=text|json]] [--trace=FILE] [--memory] [--input=FILE | --regions=MANIFEST | --pipeline < input.json | < input.json]\n";
+        return 1;
+    }
+    if (options.profile || options.trace_path) {
+        instrumentation::Profiler::Instance().Enable(options.trace_path.has_value());
+    }
+
+    try {
+        std::ios::sync_with_stdio(false);
+        if (options.regions_path) {
+            ProcessRegionalRequests(*options.regions_path);
+            WriteReports(options);
+            return 0;
+        }
+        if (options.pipeline) {
+            // Workers may warn on std::cerr, which must not flush std::cout under the writer thread.
+            std::cerr.tie(nullptr);
+            pipeline::PipelineSettings settings;
+            settings.worker_count = std::max(1u, std::thread::hardware_concurrency());
+            pipeline::ProcessStream(std::cin, std::cout, settings);
+            WriteReports(options);
+            return 0;
+        }
+
+        transport_catalogue::TransportCatalogue catalogue;
+        JsonReader requests = options.input_path ? JsonReader::FromFile(*options.input_path) : JsonReader(std::cin);
+        requests.PopulateCatalogue(catalogue);
+
+        const auto& stat_requests = requests.GetStatRequests();
+        // Settings sections are only required, and routing is only built, when some request needs them.
+        const StatRequestCounts counts = requests.CountStatRequests(stat_requests);
+        const map_renderer::MapRenderer renderer = counts.map_count > 0
+            ? requests.FillRenderSettings(requests.GetRenderSettings().AsDict())
+            : map_renderer::MapRenderer{map_renderer::RenderSettings{}};
+        const transport_router::RoutingSettings routing_settings = counts.route_count > 0
+            ? requests.ParseRoutingSettings(requests.GetRoutingSettings().AsDict())
+            : transport_router::RoutingSettings{};
+        const transport_router::TransportRouter transport_router(routing_settings, catalogue);
+        if (counts.route_count > 0) {
+            transport_router.EnsureBuilt();
+        }
+
+        if (options.print_memory) {
+            memory_usage::MemoryReport report;
+            report.Append("catalogue", catalogue.GetMemoryUsage());
+            report.Append("router", transport_router.GetMemoryUsage());
+            memory_usage::PrintMemoryReport(report, std::cerr);
+        }
+
+        RequestHandler handler(renderer, catalogue, transport_router);
+
+        requests.ProcessStatRequests(stat_requests, handler);
+
+        WriteReports(options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
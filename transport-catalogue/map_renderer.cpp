@@ -10,18 +10,18 @@ bool IsZero(double value) {
     return abs(value) < EPSILON;
 }
 
-vector<svg::Polyline> MapRenderer::RenderRouteLines(const map<string_view, const domain::Bus*>& buses, const SphereProjector& sp) const {
+vector<svg::Polyline> MapRenderer::RenderRouteLines(const map<string_view, const domain::Bus*>& buses, const SphereProjector& sp, const cancellation::Deadline& deadline) const {
     vector<svg::Polyline> result;
     size_t color = 0;
     for (const auto& [bus_name, bus] : buses) {
+        deadline.Check();
         if (bus->stops.empty()) {
             continue;
         }
 
         svg::Polyline line;
-        vector<const domain::Stop*> route_stops{bus->stops.begin(), bus->stops.end()};
-        for (const auto& stop : route_stops) {
-            line.AddPoint(sp(stop->coordinates));
+        for (size_t i = 0; i < bus->GetRouteStopCount(); ++i) {
+            line.AddPoint(sp(bus->GetRouteStop(i)->coordinates));
         }
 
         line.SetStrokeColor(render_settings_.color_palette[color]);
@@ -40,13 +40,14 @@ vector<svg::Polyline> MapRenderer::RenderRouteLines(const map<string_view, const
     return result;
 }
 
-vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain::Bus*>& buses, const SphereProjector& sp) const {
+vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain::Bus*>& buses, const SphereProjector& sp, const cancellation::Deadline& deadline) const {
     vector<svg::Text> result;
     size_t color_num = 0;
     svg::Text text;
     svg::Text underlayer;
 
     for (const auto& [bus_number, bus] : buses) {
+        deadline.Check();
         if (bus->stops.empty()) {
             continue;
         }
@@ -56,7 +57,7 @@ vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain
         text.SetFontSize(render_settings_.bus_label_font_size);
         text.SetFontFamily("Verdana");
         text.SetFontWeight("bold");
-        text.SetData(bus->name);
+        text.SetData(string{bus->name});
         text.SetFillColor(render_settings_.color_palette[color_num]);
 
         if (color_num < (render_settings_.color_palette.size() - 1)) {
@@ -70,7 +71,7 @@ vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain
         underlayer.SetFontSize(render_settings_.bus_label_font_size);
         underlayer.SetFontFamily("Verdana");
         underlayer.SetFontWeight("bold");
-        underlayer.SetData(bus->name);
+        underlayer.SetData(string{bus->name});
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -80,11 +81,11 @@ vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain
         result.push_back(underlayer);
         result.push_back(text);
 
-        if (bus->is_roundtrip == false && bus->stops.size() > 1 && bus->stops[0] != bus->stops[(bus->stops.size() - 1) / 2]) {
+        if (bus->is_roundtrip == false && bus->stops.size() > 1 && bus->stops.front() != bus->stops.back()) {
             svg::Text text2{text};
             svg::Text underlayer2{underlayer};
-            text2.SetPosition(sp(bus->stops[(bus->stops.size() - 1) / 2]->coordinates));
-            underlayer2.SetPosition(sp(bus->stops[(bus->stops.size() - 1) / 2]->coordinates));
+            text2.SetPosition(sp(bus->stops.back()->coordinates));
+            underlayer2.SetPosition(sp(bus->stops.back()->coordinates));
             
             result.push_back(underlayer2);
             result.push_back(text2);
@@ -94,9 +95,10 @@ vector<svg::Text> MapRenderer::RenderBusName(const map<string_view, const domain
     return result;
 }
 
-vector<svg::Circle> MapRenderer::RenderStopMarks(map<string_view, const domain::Stop*>& stops, const SphereProjector& sp) const {
+vector<svg::Circle> MapRenderer::RenderStopMarks(map<string_view, const domain::Stop*>& stops, const SphereProjector& sp, const cancellation::Deadline& deadline) const {
     vector<svg::Circle> result;
     for (const auto& [stop_name, stop] : stops) {
+        deadline.Check();
         svg::Circle symbol;
         symbol.SetCenter(sp(stop->coordinates));
         symbol.SetRadius(render_settings_.stop_radius);
@@ -107,24 +109,25 @@ vector<svg::Circle> MapRenderer::RenderStopMarks(map<string_view, const domain::
     return result;
 }
 
-vector<svg::Text> MapRenderer::RenderStopNames(map<string_view, const domain::Stop*>& stops, const SphereProjector& sp) const {
+vector<svg::Text> MapRenderer::RenderStopNames(map<string_view, const domain::Stop*>& stops, const SphereProjector& sp, const cancellation::Deadline& deadline) const {
     vector<svg::Text> result;
     svg::Text text;
     svg::Text underlayer;
 
     for (const auto& [stop_name, stop] : stops) {
+        deadline.Check();
         text.SetPosition(sp(stop->coordinates));
         text.SetOffset(render_settings_.stop_label_offset);
         text.SetFontSize(render_settings_.stop_label_font_size);
         text.SetFontFamily("Verdana");
-        text.SetData(stop->name);
+        text.SetData(string{stop->name});
         text.SetFillColor("black");
         
         underlayer.SetPosition(sp(stop->coordinates));
         underlayer.SetOffset(render_settings_.stop_label_offset);
         underlayer.SetFontSize(render_settings_.stop_label_font_size);
         underlayer.SetFontFamily("Verdana");
-        underlayer.SetData(stop->name);
+        underlayer.SetData(string{stop->name});
         underlayer.SetFillColor(render_settings_.underlayer_color);
         underlayer.SetStrokeColor(render_settings_.underlayer_color);
         underlayer.SetStrokeWidth(render_settings_.underlayer_width);
@@ -138,26 +141,28 @@ vector<svg::Text> MapRenderer::RenderStopNames(map<string_view, const domain::St
     return result;
 }
 
-svg::Document MapRenderer::CreateSVG(const vector<const domain::Stop*>& stops, const map<string_view, const domain::Bus*>& buses) const {
+svg::Document MapRenderer::CreateSVG(const vector<const domain::Stop*>& stops, const map<string_view, const domain::Bus*>& buses,
+                                     const cancellation::Deadline& deadline) const {
     svg::Document result;
     vector<geo::Coordinates> stops_coord;
     map<string_view, const domain::Stop*> sorted_stops;
 
     for (const auto& stop : stops) {
+        deadline.Check();
         stops_coord.push_back(stop->coordinates);
         sorted_stops.insert({stop->name, stop});
     }
     SphereProjector sp_proj(stops_coord.begin(), stops_coord.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
-    for (const auto& line : RenderRouteLines(buses, sp_proj)) {
+    for (const auto& line : RenderRouteLines(buses, sp_proj, deadline)) {
         result.Add(line);
     }
-    for (const auto& bus_name : RenderBusName(buses, sp_proj)) {
+    for (const auto& bus_name : RenderBusName(buses, sp_proj, deadline)) {
         result.Add(bus_name);
     }
-    for (const auto& stop_mark : RenderStopMarks(sorted_stops, sp_proj)) {
+    for (const auto& stop_mark : RenderStopMarks(sorted_stops, sp_proj, deadline)) {
         result.Add(stop_mark);
     }
-    for (const auto& stop_name : RenderStopNames(sorted_stops, sp_proj)) {
+    for (const auto& stop_name : RenderStopNames(sorted_stops, sp_proj, deadline)) {
         result.Add(stop_name);
     }
     return result;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cancellation.h"
 #include "geo.h"
 #include "json.h"
 #include "svg.h"
@@ -94,12 +95,18 @@ public:
         : render_settings_(render_settings)
     {}
     
-    std::vector<svg::Polyline> RenderRouteLines(const std::map<std::string_view, const domain::Bus*>& buses, const SphereProjector& sp_proj) const;
-    std::vector<svg::Text> RenderBusName(const std::map<std::string_view, const domain::Bus*>& buses, const SphereProjector& sp_proj) const;
-    std::vector<svg::Circle> RenderStopMarks(std::map<std::string_view, const domain::Stop*>& stops, const SphereProjector& sp_proj) const;
-    std::vector<svg::Text> RenderStopNames(std::map<std::string_view, const domain::Stop*>& stops, const SphereProjector& sp_proj) const;
+    std::vector<svg::Polyline> RenderRouteLines(const std::map<std::string_view, const domain::Bus*>& buses, const SphereProjector& sp_proj,
+        const cancellation::Deadline& deadline = {}) const;
+    std::vector<svg::Text> RenderBusName(const std::map<std::string_view, const domain::Bus*>& buses, const SphereProjector& sp_proj,
+        const cancellation::Deadline& deadline = {}) const;
+    std::vector<svg::Circle> RenderStopMarks(std::map<std::string_view, const domain::Stop*>& stops, const SphereProjector& sp_proj,
+        const cancellation::Deadline& deadline = {}) const;
+    std::vector<svg::Text> RenderStopNames(std::map<std::string_view, const domain::Stop*>& stops, const SphereProjector& sp_proj,
+        const cancellation::Deadline& deadline = {}) const;
     
-    svg::Document CreateSVG(const std::vector<const domain::Stop*>& stops, const std::map<std::string_view, const domain::Bus*>& buses) const;
+    // Checks deadline for every bus and stop drawn and throws DeadlineExceeded when it expires.
+    svg::Document CreateSVG(const std::vector<const domain::Stop*>& stops, const std::map<std::string_view, const domain::Bus*>& buses,
+                            const cancellation::Deadline& deadline = {}) const;
     
 private:
     const RenderSettings render_settings_;
@@ -0,0 +1,60 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace mapped_file {
+
+using namespace std::literals;
+
+namespace {
+
+std::runtime_error MakeError(const std::string& action, const std::string& path) {
+    return std::runtime_error("Cannot "s + action + " "s + path + ": "s + std::strerror(errno));
+}
+
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw MakeError("open"s, path);
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        const auto error = MakeError("stat"s, path);
+        close(fd);
+        throw error;
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    // An empty file cannot be mapped and is simply an empty view.
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            const auto error = MakeError("map"s, path);
+            close(fd);
+            throw error;
+        }
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::string_view MappedFile::GetData() const {
+    return {data_, size_};
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace mapped_file {
+
+// Read-only memory mapping of a whole file. The bytes stay valid for the object's lifetime.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view GetData() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}
@@ -0,0 +1,58 @@
+#include "memory_usage.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace memory_usage {
+
+void MemoryReport::Add(std::string name, size_t bytes) {
+    items.push_back({std::move(name), bytes});
+}
+
+void MemoryReport::Append(std::string_view component, const MemoryReport& other) {
+    for (const auto& item : other.items) {
+        Add(std::string{component} + "." + item.name, item.bytes);
+    }
+}
+
+size_t MemoryReport::GetTotalBytes() const {
+    size_t total = 0;
+    for (const auto& item : items) {
+        total += item.bytes;
+    }
+    return total;
+}
+
+void PrintMemoryReport(const MemoryReport& report, std::ostream& output) {
+    const auto flags = output.flags();
+    const size_t total = report.GetTotalBytes();
+    const auto print_line = [&output, total](std::string_view name, size_t bytes) {
+        output << std::left << std::setw(48) << name << std::right << std::setw(16) << bytes
+               << std::setw(9) << std::fixed << std::setprecision(1)
+               << (total > 0 ? bytes * 100.0 / total : 0.0) << "%\n";
+    };
+    output << std::left << std::setw(48) << "component" << std::right << std::setw(16) << "bytes" << std::setw(10) << "share"
+           << '\n';
+    for (const auto& item : report.items) {
+        print_line(item.name, item.bytes);
+    }
+    print_line("total", total);
+    output.flags(flags);
+}
+
+std::optional<size_t> GetAvailableMemory() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        size_t kilobytes = 0;
+        if (fields >> key >> kilobytes && key == "MemAvailable:") {
+            return kilobytes * 1024;
+        }
+    }
+    return std::nullopt;
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Byte footprint estimates of the standard containers, modelled on the glibc
+// allocator and the libstdc++ node layouts. They include hash buckets, node
+// links and allocator headers, but not memory owned by the elements themselves.
+namespace memory_usage {
+
+struct MemoryReport {
+    struct Item {
+        std::string name;
+        size_t bytes = 0;
+    };
+
+    std::vector<Item> items;
+
+    void Add(std::string name, size_t bytes);
+    // Adds the items of another report with names prefixed by component.
+    void Append(std::string_view component, const MemoryReport& other);
+    size_t GetTotalBytes() const;
+};
+
+void PrintMemoryReport(const MemoryReport& report, std::ostream& output);
+
+// Bytes of RAM the system can still hand out, when the platform reports it.
+std::optional<size_t> GetAvailableMemory();
+
+// Heap chunk the allocator reserves for a request of the given size.
+inline size_t HeapBytes(size_t requested) {
+    if (requested == 0) {
+        return 0;
+    }
+    constexpr size_t HEADER = sizeof(size_t);
+    constexpr size_t ALIGNMENT = 2 * sizeof(size_t);
+    constexpr size_t MIN_CHUNK = 4 * sizeof(size_t);
+    return std::max(MIN_CHUNK, (requested + HEADER + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+}
+
+template <typename T, typename Allocator>
+size_t VectorBytes(const std::vector<T, Allocator>& values) {
+    return HeapBytes(values.capacity() * sizeof(T));
+}
+
+// Outer vector plus the buffers of the nested vectors.
+template <typename T, typename Allocator, typename InnerAllocator>
+size_t VectorBytes(const std::vector<std::vector<T, InnerAllocator>, Allocator>& values) {
+    size_t bytes = HeapBytes(values.capacity() * sizeof(std::vector<T, InnerAllocator>));
+    for (const auto& inner : values) {
+        bytes += VectorBytes(inner);
+    }
+    return bytes;
+}
+
+template <typename T, typename Allocator>
+size_t DequeBytes(const std::deque<T, Allocator>& values) {
+    constexpr size_t CHUNK_BYTES = 512;
+    constexpr size_t PER_CHUNK = sizeof(T) < CHUNK_BYTES ? CHUNK_BYTES / sizeof(T) : 1;
+    constexpr size_t MIN_MAP_SIZE = 8;
+    const size_t chunk_count = values.size() / PER_CHUNK + 1;
+    const size_t map_size = std::max(MIN_MAP_SIZE, chunk_count + 2);
+    return chunk_count * HeapBytes(PER_CHUNK * sizeof(T)) + HeapBytes(map_size * sizeof(T*));
+}
+
+template <typename T, typename Allocator>
+size_t ListBytes(const std::list<T, Allocator>& values) {
+    return values.size() * HeapBytes(2 * sizeof(void*) + sizeof(T));
+}
+
+// Assumes nodes cache the key hash, which libstdc++ does for every hasher here
+// except the trivial integer ones, so the estimate errs on the high side.
+template <typename Key, typename Value, typename Hash, typename Equal, typename Allocator>
+size_t UnorderedMapBytes(const std::unordered_map<Key, Value, Hash, Equal, Allocator>& map) {
+    using Node = typename std::unordered_map<Key, Value, Hash, Equal, Allocator>::value_type;
+    const size_t node_bytes = HeapBytes(sizeof(void*) + sizeof(Node) + sizeof(size_t));
+    const size_t bucket_bytes = map.bucket_count() > 1 ? HeapBytes(map.bucket_count() * sizeof(void*)) : 0;
+    return map.size() * node_bytes + bucket_bytes;
+}
+
+}
@@ -0,0 +1,178 @@
+#include "name_search.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace name_search {
+
+using namespace std;
+
+NameSearchIndex::NameSearchIndex(vector<string_view> names)
+    : names_(move(names)) {
+    sort(names_.begin(), names_.end());
+    names_.erase(unique(names_.begin(), names_.end()), names_.end());
+    if (names_.size() >= UINT32_MAX) {
+        throw invalid_argument("Too many names for a search index"s);
+    }
+
+    for (const string_view name : names_) {
+        max_name_size_ = max(max_name_size_, name.size());
+    }
+
+    nodes_.push_back({0, 0, 0, static_cast<uint32_t>(names_.size()), 0, 0});
+    // Breadth first, so that the children of a node are appended together.
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const Node node = nodes_[i];
+        uint32_t begin = node.names_begin;
+        if (IsWholeName(node)) {
+            ++begin;
+        }
+        nodes_[i].first_child = static_cast<uint32_t>(nodes_.size());
+        while (begin < node.names_end) {
+            // Names sharing the next character form one child, labelled with their common prefix.
+            const char next_char = names_[begin][node.depth];
+            const uint32_t end = static_cast<uint32_t>(partition_point(
+                names_.begin() + begin, names_.begin() + node.names_end, [&node, next_char](string_view name) {
+                    return name[node.depth] == next_char;
+                }) - names_.begin());
+            const string_view first = names_[begin];
+            const string_view last = names_[end - 1];
+            size_t depth = node.depth + 1;
+            while (depth < first.size() && depth < last.size() && first[depth] == last[depth]) {
+                ++depth;
+            }
+            nodes_.push_back({0, 0, begin, end, node.depth, static_cast<uint32_t>(depth)});
+            ++nodes_[i].child_count;
+            begin = end;
+        }
+    }
+}
+
+string_view NameSearchIndex::GetLabel(const Node& node) const {
+    return names_[node.names_begin].substr(node.label_begin, node.depth - node.label_begin);
+}
+
+bool NameSearchIndex::IsWholeName(const Node& node) const {
+    return node.names_begin < node.names_end && names_[node.names_begin].size() == node.depth;
+}
+
+const NameSearchIndex::Node* NameSearchIndex::FindChild(const Node& node, char first_char) const {
+    const auto children_begin = nodes_.begin() + node.first_child;
+    const auto children_end = children_begin + node.child_count;
+    // Bytes compare as unsigned, as in the order of names_.
+    const auto child_iter = lower_bound(children_begin, children_end, first_char, [this](const Node& child, char value) {
+        return static_cast<unsigned char>(names_[child.names_begin][child.label_begin]) < static_cast<unsigned char>(value);
+    });
+    if (child_iter == children_end || names_[child_iter->names_begin][child_iter->label_begin] != first_char) {
+        return nullptr;
+    }
+    return &*child_iter;
+}
+
+vector<NameSearchIndex::Block> NameSearchIndex::FindPrefix(string_view query) const {
+    const Node* node = &nodes_.front();
+    while (node->depth < query.size()) {
+        const Node* child = FindChild(*node, query[node->depth]);
+        if (!child) {
+            return {};
+        }
+        const string_view label = GetLabel(*child);
+        const string_view rest = query.substr(child->label_begin);
+        const size_t common_size = min(label.size(), rest.size());
+        if (label.substr(0, common_size) != rest.substr(0, common_size)) {
+            return {};
+        }
+        node = child;
+    }
+    return {{0, node->names_begin, node->names_end}};
+}
+
+vector<NameSearchIndex::Block> NameSearchIndex::FindWithinEdits(string_view query, int max_edits) const {
+    const Node& root = nodes_.front();
+    if (query.empty()) {
+        return {{0, root.names_begin, root.names_end}};
+    }
+
+    // rows[d] holds the edit distances between every prefix of query and the path of
+    // length d being visited. The distance of a name is the least last cell over the
+    // rows of its path. No cell of a later row is below the least cell of this one,
+    // so a subtree is pruned, or taken whole, once that least cell reaches the best
+    // distance found on its path.
+    const size_t row_size = query.size() + 1;
+    vector<int> rows((max_name_size_ + 1) * row_size);
+    for (size_t j = 0; j < row_size; ++j) {
+        rows[j] = static_cast<int>(j);
+    }
+
+    vector<Block> blocks;
+    const auto visit = [&](const auto& self, const Node& node, int best) -> void {
+        const string_view name = names_[node.names_begin];
+        for (size_t depth = node.label_begin + 1; depth <= node.depth; ++depth) {
+            const int* previous = rows.data() + (depth - 1) * row_size;
+            int* current = rows.data() + depth * row_size;
+            current[0] = static_cast<int>(depth);
+            int least = current[0];
+            for (size_t j = 1; j < row_size; ++j) {
+                current[j] = min({previous[j] + 1, current[j - 1] + 1,
+                                  previous[j - 1] + (query[j - 1] != name[depth - 1] ? 1 : 0)});
+                least = min(least, current[j]);
+            }
+            best = min(best, current[row_size - 1]);
+            if (least >= best) {
+                if (best <= max_edits) {
+                    blocks.push_back({best, node.names_begin, node.names_end});
+                }
+                return;
+            }
+            if (least > max_edits) {
+                return;
+            }
+        }
+        if (IsWholeName(node) && best <= max_edits) {
+            blocks.push_back({best, node.names_begin, node.names_begin + 1});
+        }
+        for (uint32_t child = node.first_child; child < node.first_child + node.child_count; ++child) {
+            self(self, nodes_[child], best);
+        }
+    };
+
+    visit(visit, root, static_cast<int>(query.size()));
+    return blocks;
+}
+
+vector<Match> NameSearchIndex::Search(string_view query, int max_edits, size_t max_count) const {
+    if (max_edits < 0 || max_edits > MAX_EDITS) {
+        throw invalid_argument("Edit distance must be between 0 and "s + to_string(MAX_EDITS));
+    }
+    vector<Match> matches;
+    if (names_.empty()) {
+        return matches;
+    }
+    vector<Block> blocks = max_edits == 0 ? FindPrefix(query) : FindWithinEdits(query, max_edits);
+    sort(blocks.begin(), blocks.end(), [](const Block& lhs, const Block& rhs) {
+        return pair{lhs.edits, lhs.names_begin} < pair{rhs.edits, rhs.names_begin};
+    });
+    for (const Block& block : blocks) {
+        if (matches.size() == max_count) {
+            break;
+        }
+        for (uint32_t i = block.names_begin; i < block.names_end && matches.size() < max_count; ++i) {
+            matches.push_back({names_[i], block.edits});
+        }
+    }
+    return matches;
+}
+
+size_t NameSearchIndex::GetSize() const {
+    return names_.size();
+}
+
+memory_usage::MemoryReport NameSearchIndex::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Add("names_", memory_usage::VectorBytes(names_));
+    report.Add("nodes_", memory_usage::VectorBytes(nodes_));
+    return report;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "memory_usage.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace name_search {
+
+struct Match {
+    std::string_view name;
+    // Fewest single-character insertions, deletions and substitutions that turn the
+    // query into a prefix of name.
+    int edits = 0;
+};
+
+// Radix tree over a fixed set of names for autocomplete. Names are sorted, so every
+// node covers a contiguous run of them and a prefix query answers with the run of
+// the node it ends in. Nodes store no characters: the label of a node is a slice of
+// the first name below it. Comparisons are byte-wise and case-sensitive.
+class NameSearchIndex {
+public:
+    // Edit distance searches cost a row of |query| + 1 cells per visited character,
+    // and the number of visited characters grows quickly with the distance.
+    static constexpr int MAX_EDITS = 3;
+
+    NameSearchIndex() = default;
+
+    // Names must outlive the index; repeated names are kept once.
+    explicit NameSearchIndex(std::vector<std::string_view> names);
+
+    // Up to max_count names within max_edits of starting with query, by number of
+    // edits and then in byte order. Throws std::invalid_argument when max_edits is
+    // outside [0, MAX_EDITS].
+    std::vector<Match> Search(std::string_view query, int max_edits, size_t max_count) const;
+
+    size_t GetSize() const;
+    memory_usage::MemoryReport GetMemoryUsage() const;
+
+private:
+    struct Node {
+        uint32_t first_child = 0;
+        uint32_t child_count = 0;
+        // The names below the node are names_[names_begin, names_end); when the node's
+        // path spells a whole name, that name is names_[names_begin].
+        uint32_t names_begin = 0;
+        uint32_t names_end = 0;
+        // The label spans [label_begin, depth) of names_[names_begin].
+        uint32_t label_begin = 0;
+        uint32_t depth = 0;
+    };
+
+    // Names of [names_begin, names_end) in order of edits, then of position.
+    struct Block {
+        int edits = 0;
+        uint32_t names_begin = 0;
+        uint32_t names_end = 0;
+    };
+
+    std::vector<std::string_view> names_;
+    // Root first, the children of every node contiguous and sorted by first character.
+    std::vector<Node> nodes_;
+    size_t max_name_size_ = 0;
+
+    std::string_view GetLabel(const Node& node) const;
+    bool IsWholeName(const Node& node) const;
+    const Node* FindChild(const Node& node, char first_char) const;
+
+    std::vector<Block> FindPrefix(std::string_view query) const;
+    std::vector<Block> FindWithinEdits(std::string_view query, int max_edits) const;
+};
+
+}
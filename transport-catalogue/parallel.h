@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Number of contiguous chunks to split count items into: every chunk gets at least
+// min_chunk_size items and there are never more chunks than hardware threads.
+inline size_t GetChunkCount(size_t count, size_t min_chunk_size) {
+    const size_t thread_limit = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(count / std::max<size_t>(min_chunk_size, 1), 1, thread_limit);
+}
+
+// Calls func(chunk, begin, end) for chunk_count contiguous ranges covering [0, count).
+// Chunks run concurrently, the first one on the calling thread; exceptions reach the caller.
+template <typename Func>
+void ForEachChunk(size_t count, size_t chunk_count, Func func) {
+    const size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+    const auto run_chunk = [&](size_t chunk) {
+        const size_t begin = std::min(count, chunk * chunk_size);
+        func(chunk, begin, std::min(count, begin + chunk_size));
+    };
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(chunk_count);
+    for (size_t chunk = 1; chunk < chunk_count; ++chunk) {
+        workers.push_back(std::async(std::launch::async, run_chunk, chunk));
+    }
+    run_chunk(0);
+    for (auto& worker : workers) {
+        worker.get();
+    }
+}
+
+}
@@ -0,0 +1,109 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace perfect_hash::detail {
+
+using namespace std;
+
+namespace {
+
+// Average names per bucket: larger buckets make the table of displacements smaller
+// but the search for them longer.
+constexpr size_t NAMES_PER_BUCKET = 3;
+// Displacements tried for one bucket before starting over with another seed.
+constexpr uint32_t MAX_DISPLACEMENT = 1u << 20;
+constexpr int MAX_ATTEMPTS = 8;
+
+}
+
+Layout BuildLayout(const vector<string_view>& names) {
+    Layout layout;
+    if (names.empty()) {
+        return layout;
+    }
+    if (names.size() >= UINT32_MAX) {
+        throw invalid_argument("Too many names for a perfect hash index"s);
+    }
+
+    const size_t bucket_count = (names.size() + NAMES_PER_BUCKET - 1) / NAMES_PER_BUCKET;
+    vector<uint64_t> hashes(names.size());
+    vector<uint32_t> bucket_members(names.size());
+    vector<size_t> bucket_offsets(bucket_count + 1);
+    vector<uint32_t> bucket_order(bucket_count);
+    vector<bool> taken(names.size());
+    vector<uint32_t> candidate_slots;
+    layout.name_slots.resize(names.size());
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        layout.seed = Mix(attempt + 1);
+        layout.displacements.assign(bucket_count, 0);
+        fill(taken.begin(), taken.end(), false);
+
+        // Buckets as slices of bucket_members, the largest placed first while the table is empty.
+        fill(bucket_offsets.begin(), bucket_offsets.end(), 0);
+        for (size_t i = 0; i < names.size(); ++i) {
+            hashes[i] = Hash(names[i], layout.seed);
+            ++bucket_offsets[GetBucket(hashes[i], bucket_count) + 1];
+        }
+        partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+        vector<size_t> fill_positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (size_t i = 0; i < names.size(); ++i) {
+            bucket_members[fill_positions[GetBucket(hashes[i], bucket_count)]++] = static_cast<uint32_t>(i);
+        }
+        iota(bucket_order.begin(), bucket_order.end(), 0);
+        stable_sort(bucket_order.begin(), bucket_order.end(), [&bucket_offsets](uint32_t lhs, uint32_t rhs) {
+            return bucket_offsets[lhs + 1] - bucket_offsets[lhs] > bucket_offsets[rhs + 1] - bucket_offsets[rhs];
+        });
+
+        bool is_placed = true;
+        for (const uint32_t bucket : bucket_order) {
+            const size_t begin = bucket_offsets[bucket];
+            const size_t end = bucket_offsets[bucket + 1];
+            if (begin == end) {
+                break;
+            }
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = begin; j < i; ++j) {
+                    if (names[bucket_members[i]] == names[bucket_members[j]]) {
+                        throw invalid_argument("Duplicate name in a perfect hash index: "s + string{names[bucket_members[i]]});
+                    }
+                }
+            }
+
+            uint32_t displacement = 0;
+            for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+                candidate_slots.clear();
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t slot = GetSlot(hashes[bucket_members[i]], displacement, names.size());
+                    if (taken[slot] || find(candidate_slots.begin(), candidate_slots.end(), slot) != candidate_slots.end()) {
+                        break;
+                    }
+                    candidate_slots.push_back(slot);
+                }
+                if (candidate_slots.size() == end - begin) {
+                    break;
+                }
+            }
+            if (displacement == MAX_DISPLACEMENT) {
+                is_placed = false;
+                break;
+            }
+
+            layout.displacements[bucket] = displacement;
+            for (size_t i = begin; i < end; ++i) {
+                taken[candidate_slots[i - begin]] = true;
+                layout.name_slots[bucket_members[i]] = candidate_slots[i - begin];
+            }
+        }
+        if (is_placed) {
+            return layout;
+        }
+    }
+    throw runtime_error("Could not build a perfect hash index"s);
+}
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "memory_usage.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace perfect_hash {
+
+namespace detail {
+
+inline uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Reads eight bytes at a time; names are short, so this is a handful of multiplies.
+inline uint64_t Hash(std::string_view name, uint64_t seed) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = seed ^ (name.size() * MULTIPLIER);
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= name.size(); offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, name.data() + offset, sizeof(word));
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 32;
+    }
+    if (offset < name.size()) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, name.data() + offset, name.size() - offset);
+        hash = (hash ^ tail) * MULTIPLIER;
+    }
+    return Mix(hash);
+}
+
+// Maps the low 32 bits of value onto [0, range) without a division.
+inline uint32_t Reduce(uint64_t value, size_t range) {
+    return static_cast<uint32_t>(((value & UINT32_MAX) * range) >> 32);
+}
+
+inline uint32_t GetBucket(uint64_t hash, size_t bucket_count) {
+    return Reduce(hash >> 32, bucket_count);
+}
+
+inline uint32_t GetSlot(uint64_t hash, uint32_t displacement, size_t slot_count) {
+    return Reduce(Mix(hash + displacement), slot_count);
+}
+
+// Where hash and displace put a set of names: the high half of a name's hash picks its
+// bucket, and the bucket's displacement mixed into the hash picks its slot.
+struct Layout {
+    uint64_t seed = 0;
+    std::vector<uint32_t> displacements;
+    // Slot of every name, in the order the names were given.
+    std::vector<uint32_t> name_slots;
+};
+
+// Throws std::invalid_argument when a name repeats.
+Layout BuildLayout(const std::vector<std::string_view>& names);
+
+}
+
+// Minimal perfect hash from a fixed set of distinct names to values, built by hash and
+// displace: the names are split into small buckets and each bucket gets a displacement
+// that sends its names to free slots of a table with exactly one slot per name. Find
+// then costs one hash, one bucket read and one slot read with a string comparison,
+// which also rejects unknown names.
+template <typename Value>
+class NameIndex {
+public:
+    NameIndex() = default;
+
+    // Names must be distinct and outlive the index; throws std::invalid_argument on duplicates.
+    explicit NameIndex(const std::vector<std::pair<std::string_view, Value>>& entries) {
+        std::vector<std::string_view> names;
+        names.reserve(entries.size());
+        for (const auto& [name, value] : entries) {
+            names.push_back(name);
+        }
+        detail::Layout layout = detail::BuildLayout(names);
+        seed_ = layout.seed;
+        displacements_ = std::move(layout.displacements);
+        slots_.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            slots_[layout.name_slots[i]] = {entries[i].first, entries[i].second};
+        }
+    }
+
+    // Value stored with name, Value{} for a name the index was not built from.
+    Value Find(std::string_view name) const {
+        if (slots_.empty()) {
+            return Value{};
+        }
+        const uint64_t hash = detail::Hash(name, seed_);
+        const uint32_t displacement = displacements_[detail::GetBucket(hash, displacements_.size())];
+        const Slot& slot = slots_[detail::GetSlot(hash, displacement, slots_.size())];
+        if (slot.name != name) {
+            return Value{};
+        }
+        return slot.value;
+    }
+
+    size_t GetSize() const {
+        return slots_.size();
+    }
+
+    memory_usage::MemoryReport GetMemoryUsage() const {
+        memory_usage::MemoryReport report;
+        report.Add("displacements_", memory_usage::VectorBytes(displacements_));
+        report.Add("slots_", memory_usage::VectorBytes(slots_));
+        return report;
+    }
+
+private:
+    // A name and its value share a slot, so a lookup reads one cache line of the table.
+    struct Slot {
+        std::string_view name;
+        Value value{};
+    };
+
+    uint64_t seed_ = 0;
+    std::vector<uint32_t> displacements_;
+    std::vector<Slot> slots_;
+};
+
+}
@@ -0,0 +1,223 @@
+#include "pipeline.h"
+#include "instrumentation.h"
+#include "json_reader.h"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+using namespace std::literals;
+
+namespace {
+
+// First exception thrown by any stage; every queue is closed so that the other stages stop.
+class ErrorState {
+public:
+    template <typename... Queues>
+    void Fail(std::exception_ptr error, Queues&... queues) {
+        {
+            std::lock_guard guard(mutex_);
+            if (!error_) {
+                error_ = std::move(error);
+            }
+        }
+        (queues.Close(), ...);
+    }
+
+    void RethrowIfFailed() {
+        std::lock_guard guard(mutex_);
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::exception_ptr error_;
+};
+
+// Unties a stream for the guard's lifetime: reading a tied input flushes the stream it is
+// tied to, which must not happen while the writer thread is writing to it.
+class UntieGuard {
+public:
+    explicit UntieGuard(std::ios& stream)
+        : stream_(stream)
+        , tied_(stream.tie(nullptr)) {
+    }
+    UntieGuard(const UntieGuard&) = delete;
+    UntieGuard& operator=(const UntieGuard&) = delete;
+    ~UntieGuard() {
+        stream_.tie(tied_);
+    }
+
+private:
+    std::ios& stream_;
+    std::ostream* tied_;
+};
+
+// Reads stat requests with next_request until it returns nothing, answering and writing
+// them concurrently. A slot is taken per request before it is queued and given back once
+// its response is written, so at most settings.window requests are in flight.
+template <typename NextRequest>
+void RunPipeline(NextRequest next_request, const JsonReader& reader, const RequestHandler& handler,
+                 std::ostream& output, const PipelineSettings& settings) {
+    using Response = std::pair<size_t, json::Node>;
+    BoundedQueue<std::pair<size_t, StatRequest>> requests(settings.window);
+    BoundedQueue<Response> responses(settings.window);
+    BoundedQueue<bool> slots(settings.window);
+    ErrorState error_state;
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::max<size_t>(settings.worker_count, 1); ++i) {
+        workers.emplace_back([&] {
+            try {
+                while (auto request = requests.Pop()) {
+                    if (!responses.Push({request->first, reader.ExecuteStatRequest(request->second, handler)})) {
+                        return;
+                    }
+                }
+            } catch (...) {
+                error_state.Fail(std::current_exception(), requests, responses, slots);
+            }
+        });
+    }
+
+    std::thread writer([&] {
+        try {
+            json::ArrayWriter array_writer(output);
+            std::map<size_t, json::Node> pending;
+            size_t next_index = 0;
+            std::optional<Response> response = responses.Pop();
+            while (response) {
+                pending.insert(std::move(*response));
+                for (auto iter = pending.find(next_index); iter != pending.end(); iter = pending.find(next_index)) {
+                    array_writer.Write(iter->second);
+                    pending.erase(iter);
+                    ++next_index;
+                    slots.TryPop();
+                }
+                // Responses are flushed whenever the writer catches up with the workers.
+                response = responses.TryPop();
+                if (!response) {
+                    output.flush();
+                    response = responses.Pop();
+                }
+            }
+            array_writer.Finish();
+        } catch (...) {
+            error_state.Fail(std::current_exception(), requests, responses, slots);
+        }
+    });
+
+    try {
+        size_t index = 0;
+        while (auto request_node = next_request()) {
+            const auto request = reader.DecodeStatRequest(request_node->AsDict(), handler);
+            if (!request) {
+                continue;
+            }
+            if (!slots.Push(true) || !requests.Push({index++, *request})) {
+                break;
+            }
+        }
+    } catch (...) {
+        error_state.Fail(std::current_exception(), requests, responses, slots);
+    }
+
+    requests.Close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    responses.Close();
+    writer.join();
+    error_state.RethrowIfFailed();
+}
+
+// Builds the catalogue, renderer and router of reader and answers stat requests from next_request.
+template <typename NextRequest>
+void AnswerRequests(JsonReader& reader, NextRequest next_request, std::ostream& output,
+                    const PipelineSettings& settings) {
+    transport_catalogue::TransportCatalogue catalogue;
+    reader.PopulateCatalogue(catalogue);
+    const map_renderer::MapRenderer renderer = reader.MakeRenderer();
+    const transport_router::TransportRouter router(reader.MakeRoutingSettings(), catalogue);
+    const RequestHandler handler(renderer, catalogue, router);
+
+    instrumentation::ScopedTimer timer("Pipelined stat requests"sv);
+    RunPipeline(std::move(next_request), reader, handler, output, settings);
+}
+
+// Map and Route requests are streamed only once the sections they need have been read.
+bool HasRequiredSections(const json::Dict& members) {
+    return members.count("base_requests"sv) > 0 && members.count("render_settings"sv) > 0
+        && members.count("routing_settings"sv) > 0;
+}
+
+// Map and Route requests cannot be answered without their settings, as in batch mode.
+void CheckRequiredSections(const JsonReader& reader) {
+    const StatRequestCounts counts = reader.CountStatRequests(reader.GetStatRequests());
+    if (counts.map_count > 0 && !reader.GetRenderSettings().IsDict()) {
+        throw std::logic_error("Map requests need render_settings"s);
+    }
+    if (counts.route_count > 0 && !reader.GetRoutingSettings().IsDict()) {
+        throw std::logic_error("Route requests need routing_settings"s);
+    }
+}
+
+// Batch mode rejects a repeated key while loading the document, and so does the stream.
+void AddKey(std::vector<std::string>& keys, const std::string& key) {
+    if (std::find(keys.begin(), keys.end(), key) != keys.end()) {
+        throw json::ParsingError("Duplicate key '"s + key + "' have been found"s);
+    }
+    keys.push_back(key);
+}
+
+}
+
+void ProcessStream(std::istream& input, std::ostream& output, const PipelineSettings& settings) {
+    const UntieGuard untie_input(input);
+    json::ObjectReader object_reader(input);
+    json::Dict members;
+    std::vector<std::string> keys;
+    while (auto key = object_reader.NextKey()) {
+        AddKey(keys, *key);
+        if (*key == "stat_requests"sv && HasRequiredSections(members) && object_reader.StartArray()) {
+            JsonReader reader(json::Document{std::move(members)});
+            AnswerRequests(reader, [&object_reader] {
+                return object_reader.NextElement();
+            }, output, settings);
+            while (auto late_key = object_reader.NextKey()) {
+                AddKey(keys, *late_key);
+                object_reader.ReadValue();
+                // Batch mode would have applied its budgets to the requests already answered.
+                if (*late_key == "request_settings"sv) {
+                    throw std::logic_error("request_settings must come before stat_requests with --pipeline"s);
+                }
+                std::cerr << "Warning: " << *late_key << " follows stat_requests and is ignored\n";
+            }
+            return;
+        }
+        members.emplace(std::move(*key), object_reader.ReadValue());
+    }
+
+    // Otherwise the whole input has been read and is answered as in batch mode.
+    JsonReader reader(json::Document{std::move(members)});
+    CheckRequiredSections(reader);
+    const json::Node& stat_requests = reader.GetStatRequests();
+    const size_t request_count = stat_requests.IsArray() ? stat_requests.AsArray().size() : 0;
+    size_t next = 0;
+    AnswerRequests(reader, [&stat_requests, request_count, &next]() -> std::optional<json::Node> {
+        if (next == request_count) {
+            return std::nullopt;
+        }
+        return stat_requests.AsArray()[next++];
+    }, output, settings);
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "json.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+
+namespace pipeline {
+
+// FIFO queue of limited capacity shared between threads: Push waits while the queue
+// is full, Pop waits while it is empty. After Close nothing more is accepted, and Pop
+// returns nothing once the queued items are taken.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    // False, dropping the item, when the queue is closed.
+    bool Push(T item) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] {
+            return is_closed_ || items_.size() < capacity_;
+        });
+        if (is_closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> Pop() {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] {
+            return is_closed_ || !items_.empty();
+        });
+        return TakeFront();
+    }
+
+    // Nothing when the queue is empty at the moment.
+    std::optional<T> TryPop() {
+        std::lock_guard guard(mutex_);
+        return TakeFront();
+    }
+
+    void Close() {
+        std::lock_guard guard(mutex_);
+        is_closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool is_closed_ = false;
+
+    // Requires mutex_ to be held.
+    std::optional<T> TakeFront() {
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return item;
+    }
+};
+
+struct PipelineSettings {
+    size_t worker_count = 1;
+    // Most stat requests read but not yet written; bounds every queue of the pipeline.
+    size_t window = 256;
+};
+
+// Answers an input document as it arrives. Members before stat_requests are read
+// whole and the catalogue is built from them; stat requests are then parsed one by
+// one, answered by worker_count threads and their responses written, in request order,
+// by a writer thread while later requests are still being read. Requests are streamed
+// only when base_requests, render_settings and routing_settings come before
+// stat_requests; members after it are then ignored with a warning, except that a late
+// request_settings throws std::logic_error. Otherwise the requests are answered the same
+// way once the whole input is read, and, as in batch mode, Map and Route requests without
+// their settings section throw std::logic_error. A repeated key throws json::ParsingError.
+// input is untied from its output stream meanwhile, as reading it must not flush output.
+void ProcessStream(std::istream& input, std::ostream& output, const PipelineSettings& settings);
+
+}
@@ -14,22 +14,40 @@ bool RequestHandler::IsStopExists(std::string_view stop_name) const {
     return catalogue_.FindStop(stop_name);
 }
 
+const domain::Bus* RequestHandler::FindBus(std::string_view bus_name) const {
+    return catalogue_.FindBus(bus_name);
+}
+
+const domain::Stop* RequestHandler::FindStop(std::string_view stop_name) const {
+    return catalogue_.FindStop(stop_name);
+}
+
 const domain::RouteInfo RequestHandler::GetRouteInfo(std::string_view bus_name) const {
     const auto& bus = catalogue_.FindBus(bus_name);
     return catalogue_.GetRouteInfo(bus);
 }
 
-const std::vector<std::string_view> RequestHandler::GetBuses(std::string_view stop_name) const {
-    const unordered_set<string_view>& buses = catalogue_.GetBusesToStop(stop_name);
-    vector<string_view> buses_vector(buses.begin(), buses.end());
-    sort(buses_vector.begin(), buses_vector.end());
-    return buses_vector;  
+const domain::RouteInfo RequestHandler::GetRouteInfo(const domain::Bus* bus) const {
+    return catalogue_.GetRouteInfo(bus);
+}
+
+transport_catalogue::TransportCatalogue::BusNamesRange RequestHandler::GetBuses(std::string_view stop_name) const {
+    return catalogue_.GetBusesToStop(stop_name);
+}
+
+transport_catalogue::TransportCatalogue::BusNamesRange RequestHandler::GetBuses(const domain::Stop* stop) const {
+    return catalogue_.GetBusesToStop(stop);
+}
+
+vector<name_search::Match> RequestHandler::SearchStops(string_view query, int max_edits, size_t max_count) const {
+    return catalogue_.GetStopNameSearch().Search(query, max_edits, max_count);
 }
 
-svg::Document RequestHandler::RenderMap() const {
+svg::Document RequestHandler::RenderMap(const cancellation::Deadline& deadline) const {
     const unordered_map<string_view, const domain::Bus*>& all_buses = catalogue_.GetAllBuses();
     vector<const domain::Stop*> stops;
     for (const auto& [bus_number, bus] : all_buses) {
+        deadline.Check();
         for (const domain::Stop* stop : bus->stops)
         stops.push_back(stop);
     }
@@ -38,10 +56,36 @@ svg::Document RequestHandler::RenderMap() const {
         sorted_buses.emplace(bus);
     }
 
-    return renderer_.CreateSVG(stops, sorted_buses);
+    return renderer_.CreateSVG(stops, sorted_buses, deadline);
 }
 
 const std::optional<vector<const graph::Edge<double>*>> RequestHandler::GetBestRoute(
     string_view stop_from, std::string_view stop_to) const {
     return router_.GetRoute(stop_from, stop_to);
 }
+
+vector<transport_router::Route> RequestHandler::GetParetoRoutes(
+    string_view stop_from, string_view stop_to) const {
+    return router_.GetParetoRoutes(stop_from, stop_to);
+}
+
+vector<transport_router::Route> RequestHandler::GetAlternativeRoutes(
+    string_view stop_from, string_view stop_to, size_t max_count) const {
+    return router_.GetAlternativeRoutes(stop_from, stop_to, max_count);
+}
+
+const std::optional<vector<const graph::Edge<double>*>> RequestHandler::GetBestRoute(
+    const domain::Stop* stop_from, const domain::Stop* stop_to) const {
+    return router_.GetRoute(stop_from, stop_to);
+}
+
+vector<transport_router::Route> RequestHandler::GetParetoRoutes(
+    const domain::Stop* stop_from, const domain::Stop* stop_to, const cancellation::Deadline& deadline) const {
+    return router_.GetParetoRoutes(stop_from, stop_to, deadline);
+}
+
+vector<transport_router::Route> RequestHandler::GetAlternativeRoutes(
+    const domain::Stop* stop_from, const domain::Stop* stop_to, size_t max_count,
+    const cancellation::Deadline& deadline) const {
+    return router_.GetAlternativeRoutes(stop_from, stop_to, max_count, deadline);
+}
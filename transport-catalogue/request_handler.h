@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cancellation.h"
 #include "map_renderer.h"
 #include "svg.h"
 #include "transport_catalogue.h"
@@ -21,14 +22,30 @@ public:
 
     bool IsBusExists(std::string_view bus_name) const;
     bool IsStopExists(std::string_view stop_name) const;
+    const domain::Bus* FindBus(std::string_view bus_name) const;
+    const domain::Stop* FindStop(std::string_view stop_name) const;
 
     const domain::RouteInfo GetRouteInfo(std::string_view bus_name) const;
-    const std::vector<std::string_view> GetBuses(std::string_view stop_name) const;
+    const domain::RouteInfo GetRouteInfo(const domain::Bus* bus) const;
+    transport_catalogue::TransportCatalogue::BusNamesRange GetBuses(std::string_view stop_name) const;
+    transport_catalogue::TransportCatalogue::BusNamesRange GetBuses(const domain::Stop* stop) const;
+    std::vector<name_search::Match> SearchStops(std::string_view query, int max_edits, size_t max_count) const;
 
     const std::optional<std::vector<const graph::Edge<double>*>> GetBestRoute(
         std::string_view stop_from, std::string_view stop_to) const;
+    const std::optional<std::vector<const graph::Edge<double>*>> GetBestRoute(
+        const domain::Stop* stop_from, const domain::Stop* stop_to) const;
+    std::vector<transport_router::Route> GetParetoRoutes(
+        std::string_view stop_from, std::string_view stop_to) const;
+    std::vector<transport_router::Route> GetParetoRoutes(
+        const domain::Stop* stop_from, const domain::Stop* stop_to, const cancellation::Deadline& deadline = {}) const;
+    std::vector<transport_router::Route> GetAlternativeRoutes(
+        std::string_view stop_from, std::string_view stop_to, size_t max_count) const;
+    std::vector<transport_router::Route> GetAlternativeRoutes(
+        const domain::Stop* stop_from, const domain::Stop* stop_to, size_t max_count,
+        const cancellation::Deadline& deadline = {}) const;
  
-    svg::Document RenderMap() const;
+    svg::Document RenderMap(const cancellation::Deadline& deadline = {}) const;
 
 private:
     const map_renderer::MapRenderer& renderer_;
@@ -29,6 +29,10 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    memory_usage::MemoryReport GetMemoryUsage() const;
+    // Footprint of the all-pairs table for a graph of the given size, known before construction.
+    static size_t EstimateMemoryUsage(size_t vertex_count);
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -94,6 +98,20 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
+template <typename Weight>
+memory_usage::MemoryReport Router<Weight>::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Add("routes_internal_data_", memory_usage::VectorBytes(routes_internal_data_));
+    return report;
+}
+
+template <typename Weight>
+size_t Router<Weight>::EstimateMemoryUsage(size_t vertex_count) {
+    using Row = typename RoutesInternalData::value_type;
+    return memory_usage::HeapBytes(vertex_count * sizeof(Row))
+        + vertex_count * memory_usage::HeapBytes(vertex_count * sizeof(typename Row::value_type));
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
@@ -0,0 +1,98 @@
+#include "string_pool.h"
+
+#include <cstring>
+#include <functional>
+
+namespace string_pool {
+
+void StringPool::AttachBuffer(std::shared_ptr<const void> owner, std::string_view bytes) {
+    attached_buffers_.push_back({std::move(owner), bytes});
+}
+
+StringPool::Handle StringPool::Intern(std::string_view str) {
+    ++intern_calls_;
+    requested_bytes_ += str.size();
+    if (auto handle_iter = handles_.find(str); handle_iter != handles_.end()) {
+        return handle_iter->second;
+    }
+    const std::string_view stored = Store(str);
+    const Handle handle = static_cast<Handle>(strings_.size());
+    strings_.push_back(stored);
+    handles_.emplace(stored, handle);
+    return handle;
+}
+
+std::string_view StringPool::InternView(std::string_view str) {
+    return Get(Intern(str));
+}
+
+std::optional<StringPool::Handle> StringPool::Find(std::string_view str) const {
+    auto handle_iter = handles_.find(str);
+    if (handle_iter == handles_.end()) {
+        return std::nullopt;
+    }
+    return handle_iter->second;
+}
+
+std::string_view StringPool::Get(Handle handle) const {
+    return strings_.at(handle);
+}
+
+size_t StringPool::GetCount() const {
+    return strings_.size();
+}
+
+PoolStats StringPool::GetStats() const {
+    return {strings_.size(), intern_calls_, requested_bytes_, stored_bytes_, reserved_bytes_, borrowed_bytes_};
+}
+
+memory_usage::MemoryReport StringPool::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Add("blocks_", reserved_bytes_ + memory_usage::VectorBytes(blocks_));
+    report.Add("strings_", memory_usage::VectorBytes(strings_));
+    report.Add("handles_", memory_usage::UnorderedMapBytes(handles_));
+    // Only the borrowed strings: the rest of an attached buffer, such as a mapped input
+    // file, is not memory the pool needs.
+    report.Add("attached_buffers_", borrowed_bytes_);
+    return report;
+}
+
+std::string_view StringPool::Store(std::string_view str) {
+    if (str.empty()) {
+        return {};
+    }
+    if (IsInAttachedBuffer(str)) {
+        borrowed_bytes_ += str.size();
+        return str;
+    }
+    stored_bytes_ += str.size();
+    // Strings longer than a block get a block of their own, the current block stays open.
+    if (str.size() > BLOCK_SIZE) {
+        auto& block = blocks_.emplace_back(std::make_unique<char[]>(str.size()));
+        reserved_bytes_ += str.size();
+        std::memcpy(block.get(), str.data(), str.size());
+        return {block.get(), str.size()};
+    }
+    if (BLOCK_SIZE - block_used_ < str.size()) {
+        open_block_ = blocks_.emplace_back(std::make_unique<char[]>(BLOCK_SIZE)).get();
+        reserved_bytes_ += BLOCK_SIZE;
+        block_used_ = 0;
+    }
+    char* const data = open_block_ + block_used_;
+    std::memcpy(data, str.data(), str.size());
+    block_used_ += str.size();
+    return {data, str.size()};
+}
+
+bool StringPool::IsInAttachedBuffer(std::string_view str) const {
+    const std::less_equal<const char*> not_after;
+    for (const auto& buffer : attached_buffers_) {
+        if (not_after(buffer.bytes.data(), str.data())
+            && not_after(str.data() + str.size(), buffer.bytes.data() + buffer.bytes.size())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "memory_usage.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace string_pool {
+
+struct PoolStats {
+    size_t string_count = 0;
+    size_t intern_calls = 0;
+    size_t requested_bytes = 0;
+    size_t stored_bytes = 0;
+    size_t reserved_bytes = 0;
+    size_t borrowed_bytes = 0;
+};
+
+// Stores each distinct string once in a block arena. Views returned by the pool
+// stay valid for the pool's lifetime, and every string has a dense integer handle.
+// Strings lying inside an attached buffer are referenced in place instead of copied.
+class StringPool {
+public:
+    using Handle = uint32_t;
+
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // The pool keeps owner alive; bytes must stay unchanged while it does.
+    void AttachBuffer(std::shared_ptr<const void> owner, std::string_view bytes);
+
+    Handle Intern(std::string_view str);
+    std::string_view InternView(std::string_view str);
+
+    std::optional<Handle> Find(std::string_view str) const;
+    std::string_view Get(Handle handle) const;
+
+    size_t GetCount() const;
+    PoolStats GetStats() const;
+    memory_usage::MemoryReport GetMemoryUsage() const;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* open_block_ = nullptr;
+    size_t block_used_ = BLOCK_SIZE;
+    size_t reserved_bytes_ = 0;
+    size_t stored_bytes_ = 0;
+    size_t intern_calls_ = 0;
+    size_t requested_bytes_ = 0;
+    size_t borrowed_bytes_ = 0;
+
+    struct AttachedBuffer {
+        std::shared_ptr<const void> owner;
+        std::string_view bytes;
+    };
+    std::vector<AttachedBuffer> attached_buffers_;
+
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, Handle> handles_;
+
+    std::string_view Store(std::string_view str);
+    bool IsInAttachedBuffer(std::string_view str) const;
+};
+
+}
@@ -1,6 +1,7 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <unordered_set>
@@ -11,14 +12,23 @@ namespace transport_catalogue {
 using namespace std;
 using namespace domain;
 
-void TransportCatalogue::AddStop(const string& name, const geo::Coordinates coordinates) {
-    all_stops_.push_back({move(name), move(coordinates)});
+void TransportCatalogue::AttachNameBuffer(std::shared_ptr<const void> owner, std::string_view bytes) {
+    names_.AttachBuffer(std::move(owner), bytes);
+}
+
+void TransportCatalogue::AddStop(const string_view name, const geo::Coordinates coordinates) {
+    all_stops_.push_back({names_.InternView(name), coordinates, all_stops_.size(), geo::Prepare(coordinates)});
     name_to_stop_[all_stops_.back().name] = &all_stops_.back();
+    is_finalized_ = false;
 }
 
 
 void TransportCatalogue::SetDistance(const string_view stop_from, const string_view stop_to, int length) {
-    stop_route_length_.insert({{name_to_stop_.at(stop_from), name_to_stop_.at(stop_to)}, length});
+    SetDistance(name_to_stop_.at(stop_from), name_to_stop_.at(stop_to), length);
+}
+
+void TransportCatalogue::SetDistance(const Stop* stop_from, const Stop* stop_to, int length) {
+    stop_route_length_.insert({{stop_from, stop_to}, length});
 }
 
 int TransportCatalogue::GetDistance(const domain::Stop* stop_from, const domain::Stop* stop_to) const {
@@ -33,65 +43,150 @@ int TransportCatalogue::GetDistance(const domain::Stop* stop_from, const domain:
     return 0;
 }
 
-void TransportCatalogue::AddBus(const string& name, const vector<string_view>& stops, bool is_roundtrip) {
+void TransportCatalogue::AddBus(const string_view name, const vector<string_view>& stops, bool is_roundtrip) {
     vector<const Stop*> bus_stops;
+    bus_stops.reserve(stops.size());
     for (const string_view stop : stops) {
         bus_stops.push_back(name_to_stop_.at(stop));
     }
-    all_buses_.push_back({move(name), move(bus_stops), is_roundtrip});
+    AddBus(name, move(bus_stops), is_roundtrip);
+}
+
+void TransportCatalogue::AddBus(const string_view name, vector<const Stop*> stops, bool is_roundtrip) {
+    all_buses_.push_back({names_.InternView(name), move(stops), is_roundtrip, all_buses_.size()});
     name_to_bus_[all_buses_.back().name] = &all_buses_.back();
+    is_finalized_ = false;
+}
+
+void TransportCatalogue::Finalize() {
+    vector<const Bus*> sorted_buses;
+    sorted_buses.reserve(all_buses_.size());
+    for (const Bus& bus : all_buses_) {
+        sorted_buses.push_back(&bus);
+    }
+    sort(sorted_buses.begin(), sorted_buses.end(), [](const Bus* lhs, const Bus* rhs) {
+        return lhs->name < rhs->name;
+    });
+
+    // A bus may visit a stop several times; last_bus marks the bus already counted for a stop.
+    constexpr size_t NO_BUS = static_cast<size_t>(-1);
+    vector<size_t> last_bus(all_stops_.size(), NO_BUS);
+    stop_buses_offsets_.assign(all_stops_.size() + 1, 0);
+    for (const Bus* bus : sorted_buses) {
+        for (const Stop* stop : bus->stops) {
+            if (last_bus[stop->id] != bus->id) {
+                last_bus[stop->id] = bus->id;
+                ++stop_buses_offsets_[stop->id + 1];
+            }
+        }
+    }
+    for (size_t i = 1; i < stop_buses_offsets_.size(); ++i) {
+        stop_buses_offsets_[i] += stop_buses_offsets_[i - 1];
+    }
 
-    for (const Stop* stop : all_buses_.back().stops) {
-        stop_to_buses_[stop->name].insert(all_buses_.back().name);
+    // Filling in bus name order leaves every stop's slice sorted.
+    stop_buses_.resize(stop_buses_offsets_.back());
+    vector<size_t> positions(stop_buses_offsets_.begin(), stop_buses_offsets_.end() - 1);
+    fill(last_bus.begin(), last_bus.end(), NO_BUS);
+    for (const Bus* bus : sorted_buses) {
+        for (const Stop* stop : bus->stops) {
+            if (last_bus[stop->id] != bus->id) {
+                last_bus[stop->id] = bus->id;
+                stop_buses_[positions[stop->id]++] = bus->name;
+            }
+        }
     }
+
+    // Built from the hash maps, where a repeated name refers to the last stop or bus added.
+    stop_index_ = perfect_hash::NameIndex<const Stop*>({name_to_stop_.begin(), name_to_stop_.end()});
+    bus_index_ = perfect_hash::NameIndex<const Bus*>({name_to_bus_.begin(), name_to_bus_.end()});
+    is_finalized_ = true;
 }
 
 const Bus* TransportCatalogue::FindBus(const string_view name) const {
+    if (is_finalized_) {
+        return bus_index_.Find(name);
+    }
     auto bus_iter = name_to_bus_.find(name);
     return bus_iter != name_to_bus_.end() ? bus_iter->second : nullptr;
 }
 
 const Stop* TransportCatalogue::FindStop(const string_view name) const {
+    if (is_finalized_) {
+        return stop_index_.Find(name);
+    }
     auto stop_iter = name_to_stop_.find(name);
     return stop_iter != name_to_stop_.end() ? stop_iter->second : nullptr;
 }
 
-const unordered_set<string_view>& TransportCatalogue::GetBusesToStop(const string_view stop_name) const {
-    auto stop_iter = stop_to_buses_.find(stop_name);
-    static const unordered_set<string_view> empty_result;
-    return stop_iter != stop_to_buses_.end() ? stop_iter->second : empty_result;
+TransportCatalogue::BusNamesRange TransportCatalogue::GetBusesToStop(const string_view stop_name) const {
+    return GetBusesToStop(FindStop(stop_name));
+}
+
+TransportCatalogue::BusNamesRange TransportCatalogue::GetBusesToStop(const Stop* stop) const {
+    if (!is_finalized_) {
+        throw logic_error("Transport catalogue must be finalized before querying buses of a stop");
+    }
+    if (!stop) {
+        return {stop_buses_.end(), stop_buses_.end()};
+    }
+    return {stop_buses_.begin() + stop_buses_offsets_[stop->id],
+            stop_buses_.begin() + stop_buses_offsets_[stop->id + 1]};
 }
 
 const RouteInfo TransportCatalogue::GetRouteInfo(const Bus* bus) const {
     RouteInfo route;
+    route.stops_number = bus->GetRouteStopCount();
     unordered_set<string_view> unique_stops;
-    geo::Coordinates current_stop_coordinates;
-    string_view current_stop;
-    bool is_first_stop = true;
-    for (const Stop* stop : bus->stops) {
-        ++route.stops_number;
+    geo::CoordinatesSequence points;
+    points.Reserve(bus->stops.size());
+    const auto segment_length = [this](const Stop* from, const Stop* to) {
+        auto route_length_iter = stop_route_length_.find({from, to});
+        return route_length_iter != stop_route_length_.end() ? route_length_iter->second : stop_route_length_.at({to, from});
+    };
+    for (size_t i = 0; i < bus->stops.size(); ++i) {
+        const Stop* stop = bus->stops[i];
         unique_stops.insert(stop->name);
-        if (is_first_stop) {
-            current_stop_coordinates = stop->coordinates;
-            current_stop = stop->name;
-            is_first_stop = false;
-            continue;
+        points.Add(stop->prepared_coordinates);
+        if (i > 0) {
+            route.route_length += segment_length(bus->stops[i - 1], stop);
         }
-        route.distance += geo::ComputeDistance(stop->coordinates, current_stop_coordinates);
-        auto route_length_iter = stop_route_length_.find({name_to_stop_.at(current_stop), stop});
-        if (route_length_iter != stop_route_length_.end()) {
-            route.route_length += route_length_iter->second;
-        } else {
-            route.route_length += stop_route_length_.at({stop, name_to_stop_.at(current_stop)});
+    }
+
+    // The way back of a linear route covers the same segments in reverse: the road
+    // lengths may differ by direction, the great-circle distances do not.
+    vector<double> distances(points.Size() - min<size_t>(points.Size(), 1));
+    geo::ComputeDistances(points, distances.data());
+    for (const double distance : distances) {
+        route.distance += distance;
+    }
+    if (!bus->is_roundtrip) {
+        for (size_t i = distances.size(); i > 0; --i) {
+            route.route_length += segment_length(bus->stops[i], bus->stops[i - 1]);
+            route.distance += distances[i - 1];
         }
-        current_stop_coordinates = stop->coordinates;
-        current_stop = stop->name;
     }
     route.unique_stops_number = unique_stops.size();
     route.curvature = route.route_length / route.distance; 
     return route;
 }
 
+const name_search::NameSearchIndex& TransportCatalogue::GetStopNameSearch() const {
+    if (!is_finalized_) {
+        throw logic_error("Transport catalogue must be finalized before searching stop names");
+    }
+    call_once(stop_search_flag_, [this] {
+        vector<string_view> names;
+        names.reserve(name_to_stop_.size());
+        for (const auto& [name, stop] : name_to_stop_) {
+            names.push_back(name);
+        }
+        stop_search_ = make_unique<const name_search::NameSearchIndex>(move(names));
+        is_stop_search_built_.store(true, memory_order_release);
+    });
+    return *stop_search_;
+}
+
 const unordered_map<string_view, const Stop*>& TransportCatalogue::GetAllStops() const {
     return name_to_stop_;
 }
@@ -100,4 +195,43 @@ const unordered_map<string_view, const Bus*>& TransportCatalogue::GetAllBuses()
     return name_to_bus_;
 }
 
+size_t TransportCatalogue::GetStopCount() const {
+    return all_stops_.size();
+}
+
+size_t TransportCatalogue::GetBusCount() const {
+    return all_buses_.size();
+}
+
+const unordered_map<pair<const Stop*, const Stop*>, int, TransportCatalogue::StopDistancesHasher>& TransportCatalogue::GetAllDistances() const {
+    return stop_route_length_;
+}
+
+const string_pool::StringPool& TransportCatalogue::GetNamePool() const {
+    return names_;
+}
+
+memory_usage::MemoryReport TransportCatalogue::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    report.Append("names_", names_.GetMemoryUsage());
+    report.Add("all_stops_", memory_usage::DequeBytes(all_stops_));
+    size_t bus_stops_bytes = 0;
+    for (const auto& bus : all_buses_) {
+        bus_stops_bytes += memory_usage::VectorBytes(bus.stops);
+    }
+    report.Add("all_buses_", memory_usage::DequeBytes(all_buses_));
+    report.Add("all_buses_[].stops", bus_stops_bytes);
+    report.Add("name_to_stop_", memory_usage::UnorderedMapBytes(name_to_stop_));
+    report.Add("name_to_bus_", memory_usage::UnorderedMapBytes(name_to_bus_));
+    report.Add("stop_buses_offsets_", memory_usage::VectorBytes(stop_buses_offsets_));
+    report.Add("stop_buses_", memory_usage::VectorBytes(stop_buses_));
+    report.Append("stop_index_", stop_index_.GetMemoryUsage());
+    report.Append("bus_index_", bus_index_.GetMemoryUsage());
+    if (is_stop_search_built_.load(memory_order_acquire)) {
+        report.Append("stop_search_", stop_search_->GetMemoryUsage());
+    }
+    report.Add("stop_route_length_", memory_usage::UnorderedMapBytes(stop_route_length_));
+    return report;
+}
+
 }
@@ -2,17 +2,26 @@
 
 #include "domain.h"
 #include "geo.h"
+#include "memory_usage.h"
+#include "name_search.h"
+#include "perfect_hash.h"
+#include "ranges.h"
+#include "string_pool.h"
 
+#include <atomic>
 #include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace transport_catalogue {
 
 class TransportCatalogue {
 public:
+    using BusNamesRange = ranges::Range<std::vector<std::string_view>::const_iterator>;
+
     struct StopDistancesHasher {
         size_t operator()(const std::pair<const domain::Stop*, const domain::Stop*>& stops) const {
             size_t hash_first = std::hash<const void*>{}(stops.first);
@@ -21,27 +30,68 @@ public:
         }
     };
 
-    void AddStop(const std::string& name, const geo::Coordinates coordinates);
+    // Names passed later that lie inside bytes are kept as views instead of copied; see StringPool.
+    void AttachNameBuffer(std::shared_ptr<const void> owner, std::string_view bytes);
+
+    void AddStop(const std::string_view name, const geo::Coordinates coordinates);
     void SetDistance(const std::string_view stop_from, const std::string_view stop_to, int length);
-    void AddBus(const std::string& name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+    void SetDistance(const domain::Stop* stop_from, const domain::Stop* stop_to, int length);
+    // Stops as in base_requests: a linear route is given one way, see domain::Bus.
+    void AddBus(const std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+    void AddBus(const std::string_view name, std::vector<const domain::Stop*> stops, bool is_roundtrip);
 
     const domain::Bus* FindBus(const std::string_view name) const;
     const domain::Stop* FindStop(const std::string_view name) const;
     int GetDistance(const domain::Stop* stop_from, const domain::Stop* stop_to) const;
 
-    const std::unordered_set<std::string_view>& GetBusesToStop(const std::string_view stop_name) const;
+    // Builds the per-stop bus lists and the perfect hash indexes of stop and bus names;
+    // must be called after the last AddBus. Until then names are looked up by hash map.
+    void Finalize();
+
+    // Names of the buses serving the stop, sorted and unique.
+    BusNamesRange GetBusesToStop(const std::string_view stop_name) const;
+    BusNamesRange GetBusesToStop(const domain::Stop* stop) const;
     const domain::RouteInfo GetRouteInfo(const domain::Bus* bus) const;
+    // Prefix and edit-distance search over stop names, built on first use even when
+    // queried from several threads; the catalogue must be finalized and stay unchanged.
+    const name_search::NameSearchIndex& GetStopNameSearch() const;
 
     const std::unordered_map<std::string_view, const domain::Stop*>& GetAllStops() const;
     const std::unordered_map<std::string_view, const domain::Bus*>& GetAllBuses() const;  
+    // Every stop and bus ever added, so the bound of their ids; repeated names count
+    // again, while GetAllStops and GetAllBuses keep only the last of them.
+    size_t GetStopCount() const;
+    size_t GetBusCount() const;
+    const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, StopDistancesHasher>& GetAllDistances() const;
+
+    // Pool owning every stop and bus name; other modules may intern their labels here too.
+    const string_pool::StringPool& GetNamePool() const;
+
+    // Safe while another thread builds the stop name search, which is counted once built.
+    memory_usage::MemoryReport GetMemoryUsage() const;
 
 private:
+    string_pool::StringPool names_;
     std::deque<domain::Stop> all_stops_;
     std::deque<domain::Bus> all_buses_;
 
+    // Resolve names while loading, where a repeated name replaces the earlier one, and
+    // stay for GetAllStops and GetAllBuses: the router numbers its vertices in their
+    // order, and that order picks among equally fast routes.
     std::unordered_map<std::string_view, const domain::Stop*> name_to_stop_;
     std::unordered_map<std::string_view, const domain::Bus*> name_to_bus_;
-    std::unordered_map<std::string_view, std::unordered_set<std::string_view>> stop_to_buses_;
+    // Answer FindStop and FindBus once finalized.
+    perfect_hash::NameIndex<const domain::Stop*> stop_index_;
+    perfect_hash::NameIndex<const domain::Bus*> bus_index_;
+    mutable std::once_flag stop_search_flag_;
+    mutable std::atomic<bool> is_stop_search_built_ = false;
+    mutable std::unique_ptr<const name_search::NameSearchIndex> stop_search_;
+
+    // Compressed per-stop bus lists: names of the buses of the stop with id i
+    // are stop_buses_[stop_buses_offsets_[i] .. stop_buses_offsets_[i + 1]).
+    std::vector<size_t> stop_buses_offsets_;
+    std::vector<std::string_view> stop_buses_;
+    bool is_finalized_ = false;
 
     std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, StopDistancesHasher> stop_route_length_;
 };
@@ -1,27 +1,226 @@
 #include "transport_router.h"
+#include "instrumentation.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
 
 namespace transport_router {
 
+const domain::Stop* TransportRouter::GetStop(const std::string_view name) const {
+    const domain::Stop* stop = catalogue_.FindStop(name);
+    if (!stop) {
+        throw std::out_of_range("Unknown stop " + std::string{name});
+    }
+    return stop;
+}
+
 const std::optional<std::vector<const graph::Edge<double>*>> TransportRouter::GetRoute(
     const std::string_view stop_from, const std::string_view stop_to) const {
-    const auto& route_info = router_->BuildRoute(stop_ids_.at(std::string(stop_from)),stop_ids_.at(std::string(stop_to)));
+    return GetRoute(GetStop(stop_from), GetStop(stop_to));
+}
+
+const std::optional<std::vector<const graph::Edge<double>*>> TransportRouter::GetRoute(
+    const domain::Stop* stop_from, const domain::Stop* stop_to) const {
+    EnsureBuilt();
+    const std::pair key{stop_vertices_[stop_from->id], stop_vertices_[stop_to->id]};
+    if (auto cached_route = route_cache_.Find(key)) {
+        return std::move(*cached_route);
+    }
+
+    const auto& route_info = router_->BuildRoute(key.first, key.second);
     if (!route_info) {
+        route_cache_.Insert(key, std::nullopt);
         return std::nullopt;
     }
     std::vector<const graph::Edge<double>*> route;
     route.reserve(route_info.value().edges.size());
     for (graph::EdgeId edge_id : route_info.value().edges) {
         route.emplace_back(&graph_.GetEdge(edge_id));
-    }    
+    }
+    route_cache_.Insert(key, route);
 	return route;
 }
 
+cache::CacheStats TransportRouter::GetRouteCacheStats() const {
+    return route_cache_.GetStats();
+}
+
+std::vector<Route> TransportRouter::GetParetoRoutes(
+    const std::string_view stop_from, const std::string_view stop_to) const {
+    return GetParetoRoutes(GetStop(stop_from), GetStop(stop_to));
+}
+
+std::vector<Route> TransportRouter::GetParetoRoutes(
+    const domain::Stop* stop_from, const domain::Stop* stop_to, const cancellation::Deadline& deadline) const {
+    struct Label {
+        double time;
+        size_t waits;
+        graph::VertexId vertex;
+        std::optional<graph::EdgeId> edge;
+        size_t parent;
+    };
+    const auto dominates = [](const Label& lhs, const Label& rhs) {
+        return lhs.time <= rhs.time && lhs.waits <= rhs.waits;
+    };
+
+    EnsureBuilt();
+    const graph::VertexId from = stop_vertices_[stop_from->id];
+    const graph::VertexId to = stop_vertices_[stop_to->id];
+
+    std::vector<Label> labels{{0.0, 0, from, std::nullopt, 0}};
+    std::vector<std::vector<size_t>> settled(graph_.GetVertexCount());
+    using QueueItem = std::tuple<double, size_t, size_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.emplace(0.0, 0, 0);
+
+    const auto is_dominated = [&](const Label& label, graph::VertexId vertex) {
+        return std::any_of(settled[vertex].begin(), settled[vertex].end(),
+                           [&](size_t id) { return dominates(labels[id], label); });
+    };
+
+    while (!queue.empty()) {
+        deadline.Check();
+        const size_t label_id = std::get<2>(queue.top());
+        queue.pop();
+        const Label label = labels[label_id];
+        if (is_dominated(label, label.vertex) || is_dominated(label, to)) {
+            continue;
+        }
+        settled[label.vertex].push_back(label_id);
+        if (label.vertex == to) {
+            continue;
+        }
+        for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(label.vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            Label next{label.time + edge.weight, label.waits + (edge.quality == 0 ? 1 : 0),
+                       edge.to, edge_id, label_id};
+            if (is_dominated(next, edge.to) || is_dominated(next, to)) {
+                continue;
+            }
+            labels.push_back(next);
+            queue.emplace(next.time, next.waits, labels.size() - 1);
+        }
+    }
+
+    std::vector<Route> result;
+    for (const size_t target_id : settled[to]) {
+        Route route;
+        for (size_t id = target_id; labels[id].edge; id = labels[id].parent) {
+            route.push_back(&graph_.GetEdge(*labels[id].edge));
+        }
+        std::reverse(route.begin(), route.end());
+        result.push_back(std::move(route));
+    }
+    return result;
+}
+
+std::vector<Route> TransportRouter::GetAlternativeRoutes(
+    const std::string_view stop_from, const std::string_view stop_to, const size_t max_count) const {
+    return GetAlternativeRoutes(GetStop(stop_from), GetStop(stop_to), max_count);
+}
+
+std::vector<Route> TransportRouter::GetAlternativeRoutes(
+    const domain::Stop* stop_from, const domain::Stop* stop_to, const size_t max_count,
+    const cancellation::Deadline& deadline) const {
+    EnsureBuilt();
+    const graph::VertexId from = stop_vertices_[stop_from->id];
+    const graph::VertexId to = stop_vertices_[stop_to->id];
+
+    std::vector<std::vector<graph::EdgeId>> paths;
+    const auto first_path = router_->BuildRoute(from, to);
+    if (max_count == 0 || !first_path) {
+        return {};
+    }
+    paths.push_back(first_path->edges);
+
+    // Parallel edges of one bus between the same vertices describe the same itinerary,
+    // so paths are compared hop by hop rather than by edge ids.
+    using Hop = std::tuple<graph::VertexId, graph::VertexId, std::string_view>;
+    const auto to_hops = [this](const std::vector<graph::EdgeId>& path) {
+        std::vector<Hop> hops;
+        hops.reserve(path.size());
+        for (const graph::EdgeId edge_id : path) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            hops.emplace_back(edge.from, edge.to, edge.name);
+        }
+        return hops;
+    };
+
+    std::set<std::pair<double, std::vector<graph::EdgeId>>> candidates;
+    std::set<std::vector<Hop>> known_paths{to_hops(paths.front())};
+    std::vector<bool> blocked_vertices(graph_.GetVertexCount());
+    std::vector<bool> blocked_edges(graph_.GetEdgeCount());
+
+    while (paths.size() < max_count) {
+        const std::vector<Hop> last_hops = to_hops(paths.back());
+        for (size_t spur_index = 0; spur_index < last_hops.size(); ++spur_index) {
+            const graph::VertexId spur_vertex = std::get<0>(last_hops[spur_index]);
+            const auto root_begin = last_hops.begin();
+            const auto root_end = last_hops.begin() + spur_index;
+
+            std::fill(blocked_vertices.begin(), blocked_vertices.end(), false);
+            std::fill(blocked_edges.begin(), blocked_edges.end(), false);
+            for (const auto& path : paths) {
+                const std::vector<Hop> hops = to_hops(path);
+                if (hops.size() <= spur_index || !std::equal(root_begin, root_end, hops.begin())) {
+                    continue;
+                }
+                for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(spur_vertex)) {
+                    const auto& edge = graph_.GetEdge(edge_id);
+                    if (Hop{edge.from, edge.to, edge.name} == hops[spur_index]) {
+                        blocked_edges[edge_id] = true;
+                    }
+                }
+            }
+            for (auto it = root_begin; it != root_end; ++it) {
+                blocked_vertices[std::get<0>(*it)] = true;
+            }
+
+            auto spur_path = FindShortestPath(spur_vertex, to, blocked_vertices, blocked_edges, deadline);
+            if (!spur_path) {
+                continue;
+            }
+            const auto& last_path = paths.back();
+            std::vector<graph::EdgeId> candidate(last_path.begin(), last_path.begin() + spur_index);
+            candidate.insert(candidate.end(), spur_path->begin(), spur_path->end());
+            if (known_paths.insert(to_hops(candidate)).second) {
+                const double weight = GetPathWeight(candidate);
+                candidates.emplace(weight, std::move(candidate));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        paths.push_back(std::move(candidates.begin()->second));
+        candidates.erase(candidates.begin());
+    }
+
+    std::vector<Route> result;
+    result.reserve(paths.size());
+    for (const auto& path : paths) {
+        result.push_back(MakeRoute(path));
+    }
+    return result;
+}
+
 void TransportRouter::ProcessAllStops(
-    graph::DirectedWeightedGraph<double>& stops_graph, std::map<std::string, graph::VertexId>& stop_ids) {
+    std::vector<graph::Edge<double>>& edges, std::vector<graph::VertexId>& stop_vertices) const {
     graph::VertexId vertex_id = 0;
+    edges.reserve(catalogue_.GetAllStops().size());
+    // Indexed by id; copies shadowed by a repeated name get no vertex and are never looked up.
+    stop_vertices.resize(catalogue_.GetStopCount());
     for (const auto& [stop_name, stop_info] : catalogue_.GetAllStops()) {
-        stop_ids[stop_info->name] = vertex_id;
-        stops_graph.AddEdge({
+        stop_vertices[stop_info->id] = vertex_id;
+        edges.push_back({
                 stop_info->name,
                 0,
                 vertex_id,
@@ -32,60 +231,223 @@ void TransportRouter::ProcessAllStops(
     }
 }
 
-void TransportRouter::ProcessAllBuses(graph::DirectedWeightedGraph<double>& stops_graph) {
+void TransportRouter::ProcessAllBuses(std::vector<graph::Edge<double>>& edges) const {
+    std::vector<const domain::Bus*> buses;
+    buses.reserve(catalogue_.GetAllBuses().size());
     for (const auto& [bus_name, bus_info] : catalogue_.GetAllBuses()) {
-        const auto& stops = bus_info->stops;
-        const size_t stops_count = stops.size();
-
-        for (size_t i = 0; i < stops_count; ++i) {
-            for (size_t j = i + 1; j < stops_count; ++j) {
-                const domain::Stop* stop_from = stops[i];
-                const domain::Stop* stop_to = stops[j];
-
-                int forward_distance = 0;
-                int reverse_distance = 0; 
-                for (size_t k = i + 1; k <= j; ++k) {
-                    forward_distance += catalogue_.GetDistance(stops[k - 1], stops[k]);
-                    reverse_distance += catalogue_.GetDistance(stops[k], stops[k - 1]);
-                }
+        buses.push_back(bus_info);
+    }
 
-                const double velocity_factor = routing_settings_.bus_velocity * routing_settings_.KMH_TO_METERS_PER_MIN;
-                const double travel_time = static_cast<double>(forward_distance) / velocity_factor;  
+    // The number of edges of every bus is known up front, so each bus gets a fixed slice
+    // of the edge vector and workers fill their slices in place. Edge ids are the same
+    // as in a serial build and no intermediate buffers are needed.
+    std::vector<size_t> first_edges(buses.size() + 1, edges.size());
+    for (size_t i = 0; i < buses.size(); ++i) {
+        const size_t stops_count = buses[i]->stops.size();
+        const size_t pairs_count = stops_count * (stops_count - std::min<size_t>(stops_count, 1)) / 2;
+        first_edges[i + 1] = first_edges[i] + pairs_count * (buses[i]->is_roundtrip ? 1 : 2);
+    }
+    edges.resize(first_edges.back());
+
+    const size_t thread_count = parallel::GetChunkCount(buses.size(), MIN_BUSES_PER_THREAD);
+    parallel::ForEachChunk(buses.size(), thread_count, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ProcessBus(*buses[i], edges.data() + first_edges[i]);
+        }
+    });
+    build_stats_.thread_count = thread_count;
+}
+
+void TransportRouter::ProcessBus(const domain::Bus& bus, graph::Edge<double>* edges) const {
+    const auto& stops = bus.stops;
+    const size_t stops_count = stops.size();
+    const double velocity_factor = routing_settings_.bus_velocity * routing_settings_.KMH_TO_METERS_PER_MIN;
+
+    // Vertex ids and running road distances from the first stop, so that every
+    // (i, j) edge costs O(1) instead of re-summing the segment.
+    std::vector<graph::VertexId> vertices(stops_count);
+    std::vector<int> forward_prefix(stops_count, 0);
+    std::vector<int> reverse_prefix(stops_count, 0);
+    for (size_t k = 0; k < stops_count; ++k) {
+        vertices[k] = stop_vertices_[stops[k]->id];
+        if (k > 0) {
+            forward_prefix[k] = forward_prefix[k - 1] + catalogue_.GetDistance(stops[k - 1], stops[k]);
+            reverse_prefix[k] = reverse_prefix[k - 1] + catalogue_.GetDistance(stops[k], stops[k - 1]);
+        }
+    }
+
+    for (size_t i = 0; i < stops_count; ++i) {
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            const int forward_distance = forward_prefix[j] - forward_prefix[i];
+            const double travel_time = static_cast<double>(forward_distance) / velocity_factor;
 
-                stops_graph.AddEdge({
-                    bus_info->name,
+            *edges++ = {
+                bus.name,
+                static_cast<size_t>(j - i),
+                vertices[i] + 1,
+                vertices[j],
+                travel_time
+            };
+
+            if (!bus.is_roundtrip) {
+                const int reverse_distance = reverse_prefix[j] - reverse_prefix[i];
+                const double reverse_travel_time = static_cast<double>(reverse_distance) / velocity_factor;
+                *edges++ = {
+                    bus.name,
                     static_cast<size_t>(j - i),
-                    stop_ids_.at(stop_from->name) + 1,
-                    stop_ids_.at(stop_to->name),
-                    travel_time
-                });
-
-                if (!bus_info->is_roundtrip) {
-                    const double reverse_travel_time = static_cast<double>(reverse_distance) / velocity_factor;
-                    stops_graph.AddEdge({
-                        bus_info->name,
-                        static_cast<size_t>(j - i),
-                        stop_ids_.at(stop_to->name) + 1,
-                        stop_ids_.at(stop_from->name),
-                        reverse_travel_time
-                    });
-                }
+                    vertices[j] + 1,
+                    vertices[i],
+                    reverse_travel_time
+                };
             }
         }
     }
 }
 
-void TransportRouter::BuildGraph() {
-    graph::DirectedWeightedGraph<double> stops_graph(catalogue_.GetAllStops().size() * 2);
-    std::map<std::string, graph::VertexId> stop_ids;
-    
-    ProcessAllStops(stops_graph, stop_ids);
-    stop_ids_ = std::move(stop_ids);
-    
-    ProcessAllBuses(stops_graph);
+void TransportRouter::EnsureBuilt() const {
+    std::call_once(build_flag_, [this] {
+        BuildGraph();
+        is_built_.store(true, std::memory_order_release);
+    });
+}
 
-    graph_ = std::move(stops_graph);
-    router_ = std::make_unique<graph::Router<double>>(graph_);
+bool TransportRouter::IsBuilt() const {
+    return is_built_.load(std::memory_order_acquire);
 }
 
-}
\ No newline at end of file
+void TransportRouter::BuildGraph() const {
+    using Clock = std::chrono::steady_clock;
+    instrumentation::ScopedTimer timer("BuildGraph");
+    const auto stops_start = Clock::now();
+
+    std::vector<graph::Edge<double>> edges;
+    {
+        instrumentation::ScopedTimer stops_timer("BuildGraph: stops");
+        std::vector<graph::VertexId> stop_vertices;
+        ProcessAllStops(edges, stop_vertices);
+        stop_vertices_ = std::move(stop_vertices);
+    }
+
+    const auto buses_start = Clock::now();
+    {
+        instrumentation::ScopedTimer buses_timer("BuildGraph: buses");
+        ProcessAllBuses(edges);
+    }
+
+    const auto graph_start = Clock::now();
+    {
+        instrumentation::ScopedTimer graph_timer("BuildGraph: graph");
+        graph_ = graph::DirectedWeightedGraph<double>(catalogue_.GetAllStops().size() * 2, std::move(edges));
+    }
+
+    const auto router_start = Clock::now();
+    WarnIfRouterDoesNotFit();
+    {
+        instrumentation::ScopedTimer router_timer("Router precompute");
+        router_ = std::make_unique<graph::Router<double>>(graph_);
+    }
+    route_cache_.Clear();
+
+    const auto to_ms = [](Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    build_stats_.stops_ms = to_ms(buses_start - stops_start);
+    build_stats_.buses_ms = to_ms(graph_start - buses_start);
+    build_stats_.graph_ms = to_ms(router_start - graph_start);
+    build_stats_.router_ms = to_ms(Clock::now() - router_start);
+}
+
+const GraphBuildStats& TransportRouter::GetBuildStats() const {
+    return build_stats_;
+}
+
+memory_usage::MemoryReport TransportRouter::GetMemoryUsage() const {
+    memory_usage::MemoryReport report;
+    if (IsBuilt()) {
+        report.Append("graph_", graph_.GetMemoryUsage());
+        report.Add("stop_vertices_", memory_usage::VectorBytes(stop_vertices_));
+        report.Append("router_", router_->GetMemoryUsage());
+    }
+    report.Add("route_cache_", route_cache_.GetMemoryUsage());
+    return report;
+}
+
+size_t TransportRouter::EstimateRouterMemory(size_t stop_count) {
+    return graph::Router<double>::EstimateMemoryUsage(stop_count * 2);
+}
+
+void TransportRouter::WarnIfRouterDoesNotFit() const {
+    const size_t required = graph::Router<double>::EstimateMemoryUsage(graph_.GetVertexCount());
+    const std::optional<size_t> available = memory_usage::GetAvailableMemory();
+    if (available && required > *available) {
+        constexpr size_t MEGABYTE = 1024 * 1024;
+        std::cerr << "Warning: the all-pairs router for " << graph_.GetVertexCount() << " vertices needs about "
+                  << required / MEGABYTE << " MB, only " << *available / MEGABYTE << " MB available\n";
+    }
+}
+
+std::optional<std::vector<graph::EdgeId>> TransportRouter::FindShortestPath(
+    const graph::VertexId from, const graph::VertexId to,
+    const std::vector<bool>& blocked_vertices, const std::vector<bool>& blocked_edges,
+    const cancellation::Deadline& deadline) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<double> weights(vertex_count, std::numeric_limits<double>::infinity());
+    std::vector<std::optional<graph::EdgeId>> prev_edges(vertex_count);
+    using QueueItem = std::pair<double, graph::VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    weights[from] = 0.0;
+    queue.emplace(0.0, from);
+    while (!queue.empty()) {
+        deadline.Check();
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > weights[vertex]) {
+            continue;
+        }
+        if (vertex == to) {
+            break;
+        }
+        for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (blocked_edges[edge_id] || blocked_vertices[edge.to]) {
+                continue;
+            }
+            const double candidate_weight = weight + edge.weight;
+            if (candidate_weight < weights[edge.to]) {
+                weights[edge.to] = candidate_weight;
+                prev_edges[edge.to] = edge_id;
+                queue.emplace(candidate_weight, edge.to);
+            }
+        }
+    }
+
+    if (weights[to] == std::numeric_limits<double>::infinity()) {
+        return std::nullopt;
+    }
+    std::vector<graph::EdgeId> path;
+    for (graph::VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(*prev_edges[vertex]).from) {
+        path.push_back(*prev_edges[vertex]);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+double TransportRouter::GetPathWeight(const std::vector<graph::EdgeId>& path) const {
+    double weight = 0.0;
+    for (const graph::EdgeId edge_id : path) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return weight;
+}
+
+Route TransportRouter::MakeRoute(const std::vector<graph::EdgeId>& path) const {
+    Route route;
+    route.reserve(path.size());
+    for (const graph::EdgeId edge_id : path) {
+        route.push_back(&graph_.GetEdge(edge_id));
+    }
+    return route;
+}
+
+}
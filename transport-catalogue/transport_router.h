@@ -1,20 +1,40 @@
 #pragma once
 
+#include "cancellation.h"
+#include "lru_cache.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace transport_router {
 
 struct RoutingSettings {
     int bus_wait_time = 0;
     double bus_velocity = 0.0;
+    size_t route_cache_capacity = 1024;
 
     static constexpr double KMH_TO_METERS_PER_MIN = 1000.0 / 60.0;
 };
 
+using Route = std::vector<const graph::Edge<double>*>;
+
+// Wall-clock duration of each BuildGraph phase, in milliseconds.
+struct GraphBuildStats {
+    double stops_ms = 0.0;
+    double buses_ms = 0.0;
+    double graph_ms = 0.0;
+    double router_ms = 0.0;
+    size_t thread_count = 0;
+};
+
 class TransportRouter {
 public:
     TransportRouter() = default;
@@ -22,24 +42,88 @@ public:
     TransportRouter(const RoutingSettings& routing_settings, const transport_catalogue::TransportCatalogue& catalogue)
 	: routing_settings_(routing_settings)
 	, catalogue_(catalogue)
+	, route_cache_(routing_settings.route_cache_capacity)
         {
-	   BuildGraph();
 	}
 
+    // Builds the graph and the all-pairs router once; route queries call it on first use.
+    // Safe to call from several threads, later calls return immediately.
+    void EnsureBuilt() const;
+    bool IsBuilt() const;
+
+    // Queries by name throw std::out_of_range for unknown stops; queries by stop
+    // take stops of the router's catalogue and do no name lookups.
     const std::optional<std::vector<const graph::Edge<double>*>> GetRoute(
     std::string_view stop_from, std::string_view stop_to) const;
+    const std::optional<std::vector<const graph::Edge<double>*>> GetRoute(
+        const domain::Stop* stop_from, const domain::Stop* stop_to) const;
+
+    // Routes that are not dominated by each other in (total time, number of waits),
+    // ordered by total time.
+    std::vector<Route> GetParetoRoutes(std::string_view stop_from, std::string_view stop_to) const;
+    // The searches by stop check deadline as they go and throw DeadlineExceeded when it expires.
+    std::vector<Route> GetParetoRoutes(const domain::Stop* stop_from, const domain::Stop* stop_to,
+                                       const cancellation::Deadline& deadline = {}) const;
+    // Up to max_count loopless routes in order of increasing total time (Yen's algorithm).
+    std::vector<Route> GetAlternativeRoutes(
+        std::string_view stop_from, std::string_view stop_to, size_t max_count) const;
+    std::vector<Route> GetAlternativeRoutes(
+        const domain::Stop* stop_from, const domain::Stop* stop_to, size_t max_count,
+        const cancellation::Deadline& deadline = {}) const;
+
+    cache::CacheStats GetRouteCacheStats() const;
+    // Both describe the built graph and router; they are empty until EnsureBuilt.
+    // GetMemoryUsage is also safe while another thread is building them.
+    const GraphBuildStats& GetBuildStats() const;
+    memory_usage::MemoryReport GetMemoryUsage() const;
+
+    // Bytes the all-pairs router needs for a catalogue with the given number of stops.
+    static size_t EstimateRouterMemory(size_t stop_count);
 
 private:
+    static constexpr size_t MIN_BUSES_PER_THREAD = 64;
+
     const RoutingSettings routing_settings_;
     const transport_catalogue::TransportCatalogue& catalogue_;
 
-    graph::DirectedWeightedGraph<double> graph_;
-    std::map<std::string, graph::VertexId> stop_ids_;
-    std::unique_ptr<graph::Router<double>> router_;
+    // Filled by EnsureBuilt under build_flag_, read-only afterwards.
+    mutable std::once_flag build_flag_;
+    mutable std::atomic<bool> is_built_ = false;
+    mutable graph::DirectedWeightedGraph<double> graph_;
+    // Vertex where waiting at a stop begins, indexed by Stop::id.
+    mutable std::vector<graph::VertexId> stop_vertices_;
+    mutable std::unique_ptr<graph::Router<double>> router_;
+    mutable GraphBuildStats build_stats_;
+
+    // Route keys are wait vertices, which are all even: both ids go into one 64-bit word
+    // and a mixer spreads its bits over the whole hash.
+    struct VertexPairHasher {
+        size_t operator()(const std::pair<graph::VertexId, graph::VertexId>& vertices) const {
+            uint64_t key = (static_cast<uint64_t>(vertices.first) << 32) ^ static_cast<uint64_t>(vertices.second);
+            key ^= key >> 30;
+            key *= 0xbf58476d1ce4e5b9ULL;
+            key ^= key >> 27;
+            key *= 0x94d049bb133111ebULL;
+            return static_cast<size_t>(key ^ (key >> 31));
+        }
+    };
+    // Finished itineraries (including "no route") keyed by (from, to) vertices.
+    // Cleared whenever the graph is rebuilt from the catalogue and settings.
+    mutable cache::LruCache<std::pair<graph::VertexId, graph::VertexId>, std::optional<Route>, VertexPairHasher> route_cache_;
+
+    void ProcessAllStops(std::vector<graph::Edge<double>>& edges, std::vector<graph::VertexId>& stop_vertices) const;
+    void ProcessAllBuses(std::vector<graph::Edge<double>>& edges) const;
+    void ProcessBus(const domain::Bus& bus, graph::Edge<double>* edges) const;
+    void BuildGraph() const;
+    void WarnIfRouterDoesNotFit() const;
+    const domain::Stop* GetStop(std::string_view name) const;
 
-    void ProcessAllStops(graph::DirectedWeightedGraph<double>& stops_graph, std::map<std::string, graph::VertexId>& stop_ids);
-    void ProcessAllBuses(graph::DirectedWeightedGraph<double>& stops_graph);
-    void BuildGraph();
+    std::optional<std::vector<graph::EdgeId>> FindShortestPath(
+        graph::VertexId from, graph::VertexId to,
+        const std::vector<bool>& blocked_vertices, const std::vector<bool>& blocked_edges,
+        const cancellation::Deadline& deadline) const;
+    double GetPathWeight(const std::vector<graph::EdgeId>& path) const;
+    Route MakeRoute(const std::vector<graph::EdgeId>& path) const;
 };
 
 }